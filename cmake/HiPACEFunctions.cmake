@@ -182,6 +182,10 @@ function(set_hipace_binary_name)
         set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".SP")
     endif()
 
+    if(NOT HiPACE_PARTICLES_PRECISION STREQUAL HiPACE_PRECISION)
+        set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".PSP")
+    endif()
+
     #if(HiPACE_ASCENT)
     #    set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".ASCENT")
     #endif()
@@ -272,8 +276,10 @@ function(hipace_print_summary)
     message("  Build options:")
     message("    COMPUTE: ${HiPACE_COMPUTE}")
     message("    MPI: ${HiPACE_MPI}")
+    message("    BENCHMARKS: ${HiPACE_BENCHMARKS}")
     message("    OPENPMD: ${HiPACE_OPENPMD}")
     message("    PRECISION: ${HiPACE_PRECISION}")
+    message("    PARTICLES_PRECISION: ${HiPACE_PARTICLES_PRECISION}")
     message("    PUSHER: ${HiPACE_PUSHER}")
     message("")
 endfunction()
@@ -42,9 +42,12 @@ macro(find_amrex)
 
         if(HiPACE_PRECISION STREQUAL "DOUBLE")
             set(AMReX_PRECISION "DOUBLE" CACHE INTERNAL "")
-            set(AMReX_PARTICLES_PRECISION "DOUBLE" CACHE INTERNAL "")
         else()
             set(AMReX_PRECISION "SINGLE" CACHE INTERNAL "")
+        endif()
+        if(HiPACE_PARTICLES_PRECISION STREQUAL "DOUBLE")
+            set(AMReX_PARTICLES_PRECISION "DOUBLE" CACHE INTERNAL "")
+        else()
             set(AMReX_PARTICLES_PRECISION "SINGLE" CACHE INTERNAL "")
         endif()
 
@@ -129,7 +132,7 @@ macro(find_amrex)
         message(STATUS "AMReX: Using version '${AMREX_PKG_VERSION}' (${AMREX_GIT_VERSION})") 
     else()
         message(STATUS "Searching for pre-installed AMReX ...")
-        set(COMPONENT_PRECISION ${HiPACE_PRECISION} P${HiPACE_PRECISION})
+        set(COMPONENT_PRECISION ${HiPACE_PRECISION} P${HiPACE_PARTICLES_PRECISION})
         find_package(AMReX 24.08 CONFIG REQUIRED COMPONENTS 3D ${COMPONENT_PRECISION} PARTICLES)
         # note: TINYP skipped because user-configured and optional
 
@@ -34,6 +34,21 @@ parser.add_argument('--beam-out2',
                     dest='beam_out2',
                     default='',
                     help='Path to the data of the restart run')
+parser.add_argument('--iteration1',
+                    dest='iteration1',
+                    type=int,
+                    default=0,
+                    help='Iteration of the first run that is compared')
+parser.add_argument('--iteration2',
+                    dest='iteration2',
+                    type=int,
+                    default=0,
+                    help='Iteration of the restart run that is compared')
+parser.add_argument('--rtol',
+                    dest='rtol',
+                    type=float,
+                    default=1.e-8,
+                    help='Relative tolerance of the comparison')
 parser.add_argument('--SI',
                     dest='in_SI_units',
                     action='store_true',
@@ -54,8 +69,8 @@ if args.beam_py != '' and args.beam_out1 != '' and args.beam_out2 == '':
 elif args.beam_py == '' and args.beam_out1 != '' and args.beam_out2 != '':
     beam_ser[0] = io.Series(args.beam_out1,io.Access.read_only)
     beam_ser[1] = io.Series(args.beam_out2,io.Access.read_only)
-    beam_par[0] = beam_ser[0].iterations[0].particles["beam"]
-    beam_par[1] = beam_ser[1].iterations[0].particles["beam"]
+    beam_par[0] = beam_ser[0].iterations[args.iteration1].particles["beam"]
+    beam_par[1] = beam_ser[1].iterations[args.iteration2].particles["beam"]
     beam_type = [1, 1]
 
 else:
@@ -88,7 +103,7 @@ for comp in all_comps:
                 else:
                     beam_arr[i] *= beam_data.get_attribute("HiPACE++_reference_unitSI")
 
-        are_equal = np.all(np.isclose(np.sort(beam_arr[0]), np.sort(beam_arr[1]), rtol=1.e-8))
+        are_equal = np.all(np.isclose(np.sort(beam_arr[0]), np.sort(beam_arr[1]), rtol=args.rtol))
         assert are_equal, f"The two beams are not equal for {comp[1]} component"
 
 print("The two beam files are equal.")
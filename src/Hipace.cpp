@@ -17,6 +17,7 @@
 #include "utils/GPUUtil.H"
 #include "particles/pusher/GetAndSetPosition.H"
 #include "mg_solver/HpMultiGrid.H"
+#include "mg_solver/FFTBiCGStab.H"
 #include "fields/fft_poisson_solver/fft/AnyFFT.H"
 
 #include <AMReX_ParmParse.H>
@@ -28,6 +29,7 @@
 #endif
 
 #include <algorithm>
+#include <map>
 #include <memory>
 
 Hipace_early_init::Hipace_early_init (Hipace* instance)
@@ -56,7 +58,9 @@ Hipace_early_init::Hipace_early_init (Hipace* instance)
     int max_level = 0;
     queryWithParser(pp_amr, "max_level", max_level);
     m_N_level = max_level + 1;
-    AnyFFT::setup();
+    std::string fft_wisdom_file = "";
+    queryWithParser(pph, "fft_wisdom_file", fft_wisdom_file);
+    AnyFFT::setup(fft_wisdom_file);
 }
 
 Hipace_early_init::~Hipace_early_init ()
@@ -64,6 +68,19 @@ Hipace_early_init::~Hipace_early_init ()
     AnyFFT::cleanup();
 }
 
+namespace {
+    /** \brief whether a fine MR level is fully nested inside the next coarser level
+     * (with a few cells to spare) in direction dir, if it is shifted by shift
+     */
+    bool PatchIsNested (const amrex::Geometry& fine, const amrex::Geometry& coarse,
+                        const int dir, const amrex::Real shift = 0)
+    {
+        const amrex::Real margin = 2*fine.CellSize(dir) + 2*coarse.CellSize(dir);
+        return fine.ProbLo(dir) + shift - margin > coarse.ProbLo(dir) &&
+               fine.ProbHi(dir) + shift + margin < coarse.ProbHi(dir);
+    }
+}
+
 Hipace&
 Hipace::GetInstance ()
 {
@@ -82,6 +99,7 @@ Hipace::Hipace () :
 {
     amrex::ParmParse pp;// Traditionally, max_step and stop_time do not have prefix.
     queryWithParser(pp, "max_step", m_max_step);
+    m_output_max_step = m_max_step;
 
     bool use_previous_rng = false;
     queryWithParser(pp, "use_previous_rng", use_previous_rng);
@@ -103,6 +121,8 @@ Hipace::Hipace () :
         m_max_time = std::copysign(m_max_time, m_dt);
     }
     queryWithParser(pph, "max_time", m_max_time);
+    queryWithParser(pph, "checkpoint_step", m_checkpoint_step);
+    queryWithParser(pph, "checkpoint_walltime", m_checkpoint_walltime);
     queryWithParser(pph, "verbose", m_verbose);
     m_numprocs = amrex::ParallelDescriptor::NProcs();
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_numprocs <= m_max_step+1,
@@ -110,6 +130,9 @@ Hipace::Hipace () :
     queryWithParser(pph, "predcorr_B_error_tolerance", m_predcorr_B_error_tolerance);
     queryWithParser(pph, "predcorr_max_iterations", m_predcorr_max_iterations);
     queryWithParser(pph, "predcorr_B_mixing_factor", m_predcorr_B_mixing_factor);
+    queryWithParser(pph, "predcorr_anderson_depth", m_predcorr_anderson_depth);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_predcorr_anderson_depth >= 0,
+                                     "hipace.predcorr_anderson_depth must be non-negative");
     queryWithParser(pph, "do_beam_jx_jy_deposition", m_do_beam_jx_jy_deposition);
     queryWithParser(pph, "do_beam_jz_minus_rho", m_do_beam_jz_minus_rho);
     m_deposit_rho = m_diags.needsRho();
@@ -141,6 +164,7 @@ Hipace::Hipace () :
     m_salame_target_func = makeFunctionWithParser<3>(salame_target_str, m_salame_parser,
                                                      {"zeta", "zeta_initial", "Ez_initial"});
     queryWithParser(pph, "salame_relative_tolerance", m_salame_relative_tolerance);
+    queryWithParser(pph, "salame_sub_box_guard_cells", m_salame_sub_box_guard);
 
     std::string solver = "explicit";
     queryWithParser(pph, "bxby_solver", solver);
@@ -154,13 +178,32 @@ Hipace::Hipace () :
     queryWithParser(pph, "MG_tolerance_rel", m_MG_tolerance_rel);
     queryWithParser(pph, "MG_tolerance_abs", m_MG_tolerance_abs);
     queryWithParser(pph, "MG_verbose", m_MG_verbose);
+    queryWithParser(pph, "MG_warm_start", m_MG_warm_start);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_MG_warm_start >= 0 && m_MG_warm_start <= 2,
+        "hipace.MG_warm_start must be 0, 1 or 2");
     queryWithParser(pph, "use_amrex_mlmg", m_use_amrex_mlmg);
+    queryWithParser(pph, "use_fft_bicgstab", m_use_fft_bicgstab);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(m_use_amrex_mlmg && m_use_fft_bicgstab),
+        "hipace.use_amrex_mlmg and hipace.use_fft_bicgstab cannot be used together");
     queryWithParser(pph, "do_shared_depos", m_do_shared_depos);
     queryWithParser(pph, "do_tiling", m_do_tiling);
     queryWithParser(pph, "tile_size", m_tile_size);
+    queryWithParser(pph, "do_simd_depos", m_do_simd_depos);
+    queryWithParser(pph, "persistent_particle_bins", m_persistent_particle_bins);
 #ifdef AMREX_USE_GPU
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_do_tiling==0, "Tiling must be turned off to run on GPU.");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_do_simd_depos==0,
+        "hipace.do_simd_depos is only supported on CPU.");
 #endif
+    queryWithParser(pph, "use_gpu_graphs", m_slice_graph.m_enabled);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_slice_graph.m_enabled || GPUGraph::IsSupported(),
+        "hipace.use_gpu_graphs requires a CUDA or HIP build");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_slice_graph.m_enabled ||
+        (DO_DEVICE_SYNCHRONIZE == 0 && !do_mfi_sync),
+        "hipace.use_gpu_graphs cannot be used together with hipace.do_device_synchronize "
+        "or hipace.do_MFIter_synchronize");
+    queryWithParser(pph, "phase_timers_period", m_phase_timers.m_period);
+    queryWithParser(pph, "phase_timers_file_prefix", m_phase_timers.m_file_prefix);
 
     queryWithParser(pph, "background_density_SI", m_background_density_SI);
     DeprecatedInput("hipace", "comms_buffer_on_gpu", "comms_buffer.on_gpu", "", true);
@@ -230,9 +273,19 @@ Hipace::Hipace () :
 
     m_use_laser = m_multi_laser.UseLaser();
 
+    queryWithParser(pph, "fused_plasma_push_deposit", m_fused_plasma_push_deposit);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_fused_plasma_push_deposit ||
+        (m_explicit && !m_use_laser && m_N_level == 1 && !m_deposit_rho_individual),
+        "hipace.fused_plasma_push_deposit requires the explicit solver and does not work with "
+        "a laser, mesh refinement or hipace.deposit_rho_individual");
+
     queryWithParser(pph, "collisions", m_collision_names);
     /** Initialize the collision objects */
     m_ncollisions = m_collision_names.size();
+    // collisions modify the plasma momentum after the push, which would be missed by the
+    // current already deposited in the push
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_fused_plasma_push_deposit || m_ncollisions == 0,
+        "hipace.fused_plasma_push_deposit does not work with collisions");
      for (int i = 0; i < m_ncollisions; ++i) {
          m_all_collisions.emplace_back(CoulombCollision(m_multi_plasma.m_names, m_multi_beam.m_names, m_collision_names[i]));
      }
@@ -268,7 +321,16 @@ Hipace::InitData ()
         m_fields.AllocData(lev, m_3D_geom[lev], m_slice_ba[lev], m_slice_dm[lev]);
     }
 
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_slice_graph.m_enabled || m_fields.SupportsGPUGraphs(),
+        "hipace.use_gpu_graphs does not work with fields.poisson_solver = MGDirichlet "
+        "and with open or periodic field boundaries");
+
     m_diags.Initialize(m_N_level, m_multi_laser.UseLaser());
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE((m_checkpoint_step < 0 &&
+        m_checkpoint_walltime == std::numeric_limits<double>::infinity()) ||
+        (m_diags.hasBeamOutput(m_max_step, m_max_step, m_max_time, m_max_time) &&
+         static_cast<int>(getDiagBeamNames().size()) == m_multi_beam.get_nbeams()),
+        "hipace.checkpoint_step and hipace.checkpoint_walltime require the output of all beams");
 
     m_initial_time = m_multi_beam.InitData(m_3D_geom[0]);
 
@@ -298,6 +360,9 @@ void
 Hipace::MakeGeometry ()
 {
     m_3D_geom.resize(m_N_level);
+    m_mr_track_beam.resize(m_N_level, -1);
+    m_mr_patch_initial.resize(m_N_level);
+    m_mr_track_acc.resize(m_N_level);
     m_3D_dm.resize(m_N_level);
     m_3D_ba.resize(m_N_level);
     m_slice_geom.resize(m_N_level);
@@ -356,18 +421,27 @@ Hipace::MakeGeometry ()
                               amrex::CoordSys::cartesian, {0, 0, 0});
 
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-            m_3D_geom[lev].ProbLo(0)-2*m_3D_geom[lev].CellSize(0)-2*m_3D_geom[lev-1].CellSize(0)
-            >  m_3D_geom[lev-1].ProbLo(0) &&
-            m_3D_geom[lev].ProbHi(0)+2*m_3D_geom[lev].CellSize(0)+2*m_3D_geom[lev-1].CellSize(0)
-            <  m_3D_geom[lev-1].ProbHi(0) &&
-            m_3D_geom[lev].ProbLo(1)-2*m_3D_geom[lev].CellSize(1)-2*m_3D_geom[lev-1].CellSize(1)
-            >  m_3D_geom[lev-1].ProbLo(1) &&
-            m_3D_geom[lev].ProbHi(1)+2*m_3D_geom[lev].CellSize(1)+2*m_3D_geom[lev-1].CellSize(1)
-            <  m_3D_geom[lev-1].ProbHi(1),
+            PatchIsNested(m_3D_geom[lev], m_3D_geom[lev-1], 0) &&
+            PatchIsNested(m_3D_geom[lev], m_3D_geom[lev-1], 1),
             "Fine MR level must be fully nested inside the next coarsest level "
             "(with a few cells to spare)"
         );
 
+        // optionally move the patch transversely with the centroid of a beam
+        std::string track_beam = "";
+        queryWithParser(pp_mrlev, "track_beam", track_beam);
+        for (int ibeam=0; ibeam<m_multi_beam.get_nbeams(); ++ibeam) {
+            if (m_multi_beam.getBeam(ibeam).get_name() == track_beam) {
+                m_mr_track_beam[lev] = ibeam;
+            }
+        }
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(track_beam.empty() || m_mr_track_beam[lev] >= 0,
+            "mr_lev" + std::to_string(lev) + ".track_beam must be the name of a beam");
+        m_mr_patch_initial[lev] = m_3D_geom[lev].ProbDomain();
+        if (m_mr_track_beam[lev] >= 0) {
+            m_mr_track_acc[lev].resize(1);
+        }
+
         amrex::BoxList bl_lev{domain_3D_lev};
         amrex::Vector<int> procmap_lev{amrex::ParallelDescriptor::MyProc()};
         m_3D_ba[lev].define(bl_lev);
@@ -376,20 +450,112 @@ Hipace::MakeGeometry ()
 
     // make slice Geometry, BoxArray, DistributionMapping every level
     for (int lev=0; lev<m_N_level; ++lev) {
-        amrex::Box slice_box = m_3D_geom[lev].Domain();
-        slice_box.setSmall(2, 0);
-        slice_box.setBig(2, 0);
-        amrex::RealBox slice_realbox = m_3D_geom[lev].ProbDomain();
-        slice_realbox.setLo(2, 0.);
-        slice_realbox.setHi(2, m_3D_geom[lev].CellSize(2));
-
-        m_slice_geom[lev].define(slice_box, slice_realbox, amrex::CoordSys::cartesian,
-                                 m_3D_geom[lev].isPeriodic());
-        m_slice_ba[lev].define(slice_box);
+        MakeSliceGeometry(lev);
+        m_slice_ba[lev].define(m_slice_geom[lev].Domain());
         m_slice_dm[lev].define(amrex::Vector<int>({amrex::ParallelDescriptor::MyProc()}));
     }
 }
 
+void
+Hipace::MakeSliceGeometry (const int lev)
+{
+    amrex::Box slice_box = m_3D_geom[lev].Domain();
+    slice_box.setSmall(2, 0);
+    slice_box.setBig(2, 0);
+    amrex::RealBox slice_realbox = m_3D_geom[lev].ProbDomain();
+    slice_realbox.setLo(2, 0.);
+    slice_realbox.setHi(2, m_3D_geom[lev].CellSize(2));
+
+    m_slice_geom[lev].define(slice_box, slice_realbox, amrex::CoordSys::cartesian,
+                             m_3D_geom[lev].isPeriodic());
+}
+
+void
+Hipace::AccumulateMRPatchTracking ()
+{
+    for (int lev=1; lev<m_N_level; ++lev) {
+        if (m_mr_track_beam[lev] < 0) continue;
+        HIPACE_PROFILE("Hipace::AccumulateMRPatchTracking()");
+
+        const auto& beam = m_multi_beam.getBeam(m_mr_track_beam[lev]);
+        const auto& soa = beam.getBeamSlice(WhichBeamSlice::This).GetStructOfArrays();
+        const amrex::ParticleReal * const pos_x = soa.GetRealData(BeamIdx::x).data();
+        const amrex::ParticleReal * const pos_y = soa.GetRealData(BeamIdx::y).data();
+        const amrex::ParticleReal * const wp = soa.GetRealData(BeamIdx::w).data();
+        const auto * const idcpup = soa.GetIdCPUData().data();
+
+        m_mr_track_acc[lev].Reduce(0, beam.getNumParticles(WhichBeamSlice::This),
+            [=] AMREX_GPU_DEVICE (int ip) noexcept
+            {
+                const amrex::Real w = amrex::ConstParticleIDWrapper(idcpup[ip]) < 0 ? 0 : wp[ip];
+                return amrex::GpuArray<amrex::Real, 3>{w, w * pos_x[ip], w * pos_y[ip]};
+            });
+    }
+}
+
+void
+Hipace::UpdateMRPatches ()
+{
+    if (std::all_of(m_mr_track_beam.begin(), m_mr_track_beam.end(),
+                    [] (int ibeam) { return ibeam < 0; })) return;
+    HIPACE_PROFILE("Hipace::UpdateMRPatches()");
+
+    for (int lev=1; lev<m_N_level; ++lev) {
+        const amrex::RealBox& patch_initial = m_mr_patch_initial[lev];
+        amrex::Real sum_w = 0, sum_wx = 0, sum_wy = 0;
+        if (m_mr_track_beam[lev] >= 0) {
+            m_mr_track_acc[lev].CopyToHost();
+            sum_w = m_mr_track_acc[lev].get(0, 0);
+            sum_wx = m_mr_track_acc[lev].get(0, 1);
+            sum_wy = m_mr_track_acc[lev].get(0, 2);
+        }
+
+        // untracked levels, or tracked levels without beam particles on this rank, stay at
+        // their initial position if possible, but may have to move to stay nested
+        amrex::Geometry geom_initial {m_3D_geom[lev].Domain(), patch_initial,
+                                      amrex::CoordSys::cartesian, {0, 0, 0}};
+        amrex::RealBox patch = patch_initial;
+        for (int dir=0; dir<2; ++dir) {
+            const amrex::Real dx_coarse = m_3D_geom[lev-1].CellSize(dir);
+            const amrex::Real center_initial = 0.5*(patch_initial.lo(dir) + patch_initial.hi(dir));
+            const amrex::Real center_coarse = 0.5*(m_3D_geom[lev-1].ProbLo(dir)
+                                                   + m_3D_geom[lev-1].ProbHi(dir));
+            const amrex::Real centroid = sum_w == 0 ? center_initial :
+                (dir == 0 ? sum_wx : sum_wy) / sum_w;
+            const int n_beam = int(amrex::Math::round((centroid - center_initial) / dx_coarse));
+            const int n_center =
+                int(amrex::Math::round((center_coarse - center_initial) / dx_coarse));
+            // move from the beam centroid towards the center of the coarser level
+            // until the patch is nested
+            int n = n_beam;
+            while (n != n_center &&
+                   !PatchIsNested(geom_initial, m_3D_geom[lev-1], dir, n*dx_coarse)) {
+                n += n_center > n ? 1 : -1;
+            }
+            patch.setLo(dir, patch_initial.lo(dir) + n*dx_coarse);
+            patch.setHi(dir, patch_initial.hi(dir) + n*dx_coarse);
+        }
+
+        const bool patch_moved = patch.lo(0) != m_3D_geom[lev].ProbLo(0) ||
+                                 patch.lo(1) != m_3D_geom[lev].ProbLo(1);
+
+        m_3D_geom[lev].define(m_3D_geom[lev].Domain(), patch,
+                              amrex::CoordSys::cartesian, {0, 0, 0});
+        MakeSliceGeometry(lev);
+
+        if (patch_moved) {
+            // the captured GPU graphs contain the patch geometry of the previous time step
+            m_slice_graph.clear();
+        }
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            PatchIsNested(m_3D_geom[lev], m_3D_geom[lev-1], 0) &&
+            PatchIsNested(m_3D_geom[lev], m_3D_geom[lev-1], 1),
+            "mr_lev" + std::to_string(lev) + " could not be moved to stay nested "
+            "inside the next coarsest level");
+    }
+}
+
 void
 Hipace::Evolve ()
 {
@@ -434,6 +600,16 @@ Hipace::Evolve ()
             next_time = m_physical_time + m_dt;
         }
 
+        // A checkpoint step is the last step of the simulation. It writes the output of the
+        // last step, which contains the beams before the push and can be used to restart at this
+        // step, and stops all ranks with later time steps. Earlier time steps are finished.
+        const bool is_checkpoint = step < m_max_step && !m_has_last_step &&
+            (step == m_checkpoint_step || amrex::second() - start_time >= m_checkpoint_walltime);
+        if (is_checkpoint) {
+            m_has_last_step = true;
+            next_time = std::numeric_limits<amrex::Real>::infinity();
+        }
+
         if (m_verbose >= 1) {
             std::cout << utils::format_time{amrex::second() - start_time}
                       << " Rank " << rank
@@ -446,6 +622,16 @@ Hipace::Evolve ()
             m_multi_buffer.put_time(next_time);
         }
 
+        if (is_checkpoint) {
+            if (m_verbose >= 1) {
+                std::cout << "Rank " << rank << " writes a checkpoint at step " << step
+                          << ", restart with <beam name>.iteration = " << step << std::endl;
+            }
+            // Only the output treats this step as the last one. Like with max_time, the loop
+            // continues until the infinite time forwarded by the other ranks is received.
+            m_output_max_step = step;
+        }
+
         // Only reset plasma after receiving time step, to use proper density
         m_multi_plasma.InitData(m_slice_ba, m_slice_dm, m_slice_geom, m_3D_geom);
 
@@ -473,6 +659,7 @@ Hipace::Evolve ()
 
         // need correct physical time for this
         InitDiagnostics(step);
+        m_phase_timers.BeginStep(step, m_physical_time, m_output_max_step, m_max_time);
 
         // Solve slices
         for (int isl = bx.bigEnd(Direction::z); isl >= bx.smallEnd(Direction::z); --isl){
@@ -482,12 +669,27 @@ Hipace::Evolve ()
         m_adaptive_time_step.CalculateFromMinUz(
             m_physical_time, m_dt, m_multi_beam, m_multi_plasma);
 
+        if (m_verbose >= 1) {
+            m_adaptive_time_step.ReportBeamSubcycles(m_multi_beam, step);
+        }
+
+        if (m_verbose >= 1 && m_multi_buffer.is_adaptive_depth()) {
+            std::cout << "Rank " << rank << " finished step " << step
+                      << " with comms_buffer depths: max leading slices "
+                      << m_multi_buffer.get_max_leading_slices() << ", max trailing slices "
+                      << m_multi_buffer.get_max_trailing_slices() << std::endl;
+        }
+
         WriteDiagnostics(step);
 
-        m_fields.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_max_step, m_max_time);
-        m_multi_beam.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_max_step, m_max_time);
-        m_multi_plasma.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_max_step, m_max_time);
-        m_multi_laser.InSituWriteToFile(step, m_physical_time, m_max_step, m_max_time);
+        m_fields.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_output_max_step, m_max_time);
+        m_multi_beam.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_output_max_step, m_max_time);
+        m_multi_plasma.InSituWriteToFile(step, m_physical_time, m_3D_geom[0], m_output_max_step, m_max_time);
+        m_multi_laser.InSituWriteToFile(step, m_physical_time, m_output_max_step, m_max_time);
+        m_phase_timers.WriteToFile(step, m_physical_time);
+
+        // after all output of this time step used the current MR patches
+        UpdateMRPatches();
 
         if (!m_explicit) {
             // averaging predictor corrector loop diagnostics
@@ -497,15 +699,26 @@ Hipace::Evolve ()
                 amrex::AllPrint() << "Rank " << rank
                                   << ": avg. number of iterations " << m_predcorr_avg_iterations
                                   <<" avg. transverse B field error " << m_predcorr_avg_B_error
+                                  << " max. number of iterations " << m_predcorr_max_used_iterations
+                                  << " unconverged slices " << m_predcorr_unconverged_slices
                                   << "\n";
             }
             m_predcorr_avg_iterations = 0.;
             m_predcorr_avg_B_error = 0.;
+            m_predcorr_max_used_iterations = 0;
+            m_predcorr_unconverged_slices = 0;
         }
 
         FlushDiagnostics();
     }
 
+#ifdef HIPACE_USE_OPENPMD
+    // the IO thread may still write the last output steps, report their errors
+    m_openpmd_writer.WaitForIO();
+#endif
+
+    m_multi_buffer.write_trace();
+
     if (m_verbose >= 1) {
         // print total time, time per particle push and time per cell update
         amrex::ParallelDescriptor::ReduceRealSum(amrex::Vector<std::reference_wrapper<double>>{
@@ -580,11 +793,15 @@ Hipace::SolveOneSlice (int islice, int step)
     }
 
     if (islice == m_3D_geom[0].Domain().bigEnd(2)) {
+        m_phase_timers.Start(Phase::MultiBufferReceive);
         m_multi_buffer.get_data(islice, m_multi_beam, m_multi_laser, WhichBeamSlice::This);
+        m_phase_timers.Stop(Phase::MultiBufferReceive);
         m_multi_beam.ReorderParticles( WhichBeamSlice::This, step, m_slice_geom[0]);
     }
 
-    m_multi_plasma.InSituComputeDiags(step, islice, m_max_step, m_physical_time, m_max_time);
+    m_phase_timers.Start(Phase::InSituDiagnostics);
+    m_multi_plasma.InSituComputeDiags(step, islice, m_output_max_step, m_physical_time, m_max_time);
+    m_phase_timers.Stop(Phase::InSituDiagnostics);
 
     if (m_N_level > 1) {
         m_multi_beam.TagByLevel(current_N_level, m_3D_geom, WhichSlice::This);
@@ -595,9 +812,25 @@ Hipace::SolveOneSlice (int islice, int step)
     m_multi_plasma.ReorderParticles(islice);
 
     // prepare/initialize fields
-    for (int lev=0; lev<current_N_level; ++lev) {
-        m_fields.InitializeSlices(lev, islice, m_3D_geom);
+    // on the first slice of an MR level the fields are interpolated from the coarser level,
+    // which is only done once and therefore not captured
+    bool is_first_slice_of_level = false;
+    for (int lev=1; lev<current_N_level; ++lev) {
+        is_first_slice_of_level |= islice == m_3D_geom[lev].Domain().bigEnd(Direction::z);
     }
+    auto initialize_slices = [&] () {
+        for (int lev=0; lev<current_N_level; ++lev) {
+            m_fields.InitializeSlices(lev, islice, m_3D_geom);
+        }
+    };
+    if (is_first_slice_of_level) {
+        initialize_slices();
+    } else {
+        m_slice_graph.Run({0, current_N_level}, initialize_slices);
+    }
+
+    // restrict the laser to where the envelope is non-negligible
+    m_multi_laser.UpdateActiveWindow(islice);
 
     // write laser aabs into fields MultiFab
     m_multi_laser.UpdateLaserAabs(islice, current_N_level, m_fields, m_3D_geom);
@@ -605,39 +838,63 @@ Hipace::SolveOneSlice (int islice, int step)
     // deposit current
     for (int lev=0; lev<current_N_level; ++lev) {
         if (m_explicit) {
-            // deposit jx, jy, chi and rhomjz for all plasmas
-            m_multi_plasma.DepositCurrent(m_fields, WhichSlice::This, true, false,
-                m_deposit_rho || m_deposit_rho_individual, true, true, m_3D_geom, lev);
+            // deposit jx, jy, chi and rhomjz for all plasmas.
+            // With the fused push and deposition, this was already done during the plasma push
+            // of the previous slice, except on the first slice
+            m_phase_timers.Start(Phase::PlasmaDeposition);
+            if (!m_fused_plasma_push_deposit || islice == m_3D_geom[0].Domain().bigEnd(2)) {
+                m_multi_plasma.DepositCurrent(m_fields, WhichSlice::This, true, false,
+                    m_deposit_rho || m_deposit_rho_individual, true, true, m_3D_geom, lev);
+            }
+            m_phase_timers.Stop(Phase::PlasmaDeposition);
 
             // deposit jz_beam and maybe rhomjz of the beam on This slice
+            m_phase_timers.Start(Phase::BeamDeposition);
             m_multi_beam.DepositCurrentSlice(m_fields, m_3D_geom, lev, step,
                 false, true, m_do_beam_jz_minus_rho, WhichSlice::This, WhichBeamSlice::This);
+            m_phase_timers.Stop(Phase::BeamDeposition);
         } else {
             // deposit jx jy jz (maybe chi) and rhomjz
+            m_phase_timers.Start(Phase::PlasmaDeposition);
             m_multi_plasma.DepositCurrent(m_fields, WhichSlice::This, true, true,
                 m_deposit_rho || m_deposit_rho_individual, m_use_laser, true, m_3D_geom, lev);
+            m_phase_timers.Stop(Phase::PlasmaDeposition);
 
             // deposit jx jy jz and maybe rhomjz on This slice
+            m_phase_timers.Start(Phase::BeamDeposition);
             m_multi_beam.DepositCurrentSlice(m_fields, m_3D_geom, lev, step,
                 m_do_beam_jx_jy_deposition, true, m_do_beam_jz_minus_rho,
                 WhichSlice::This, WhichBeamSlice::This);
+            m_phase_timers.Stop(Phase::BeamDeposition);
         }
         // add neutralizing background
+        m_phase_timers.Start(Phase::PlasmaDeposition);
         m_fields.AddRhoIons(lev);
+        m_phase_timers.Stop(Phase::PlasmaDeposition);
 
         // deposit grid current into jz_beam
+        m_phase_timers.Start(Phase::BeamDeposition);
         m_grid_current.DepositCurrentSlice(m_fields, m_3D_geom[lev], lev, islice);
+        m_phase_timers.Stop(Phase::BeamDeposition);
     }
 
     // Psi ExmBy EypBx Ez Bz solve
-    m_fields.SolvePoissonPsiExmByEypBxEzBz(m_3D_geom, current_N_level);
+    m_phase_timers.Start(Phase::PoissonSolve);
+    m_slice_graph.Run({1, current_N_level}, [&] () {
+        m_fields.SolvePoissonPsiExmByEypBxEzBz(m_3D_geom, current_N_level);
+    });
+    m_phase_timers.Stop(Phase::PoissonSolve);
 
     // Advance laser slice by 1 step using chi
     // no MR for laser
+    m_phase_timers.Start(Phase::Laser);
     m_multi_laser.AdvanceSlice(islice, m_fields, m_dt, step, m_3D_geom[0]);
+    m_phase_timers.Stop(Phase::Laser);
 
     if (islice-1 >= m_3D_geom[0].Domain().smallEnd(2)) {
+        m_phase_timers.Start(Phase::MultiBufferReceive);
         m_multi_buffer.get_data(islice-1, m_multi_beam, m_multi_laser, WhichBeamSlice::Next);
+        m_phase_timers.Stop(Phase::MultiBufferReceive);
         m_multi_beam.ReorderParticles( WhichBeamSlice::Next, step, m_slice_geom[0]);
     }
 
@@ -653,74 +910,111 @@ Hipace::SolveOneSlice (int islice, int step)
             // it is implemented in the WAND-PIC quasistatic PIC code.
 
             // deposit jx_beam and jy_beam in the Next slice
+            m_phase_timers.Start(Phase::BeamDeposition);
             m_multi_beam.DepositCurrentSlice(m_fields, m_3D_geom, lev, step,
                 m_do_beam_jx_jy_deposition, false, false, WhichSlice::Next, WhichBeamSlice::Next);
+            m_phase_timers.Stop(Phase::BeamDeposition);
 
             // Set Sx and Sy to beam contribution
+            m_phase_timers.Start(Phase::ExplicitDeposition);
             InitializeSxSyWithBeam(lev);
 
             // Deposit Sx and Sy for every plasma species
             m_multi_plasma.ExplicitDeposition(m_fields, m_3D_geom, lev);
+            m_phase_timers.Stop(Phase::ExplicitDeposition);
 
             // Solves Bx, By using Sx, Sy and chi
-            ExplicitMGSolveBxBy(lev, WhichSlice::This);
+            m_phase_timers.Start(Phase::ExplicitSolve);
+            ExplicitMGSolveBxBy(lev, WhichSlice::This, islice);
+            m_phase_timers.Stop(Phase::ExplicitSolve);
         }
     } else {
         // Solves Bx and By in the current slice and modifies the force terms of the plasma particles
+        m_phase_timers.Start(Phase::PredictorCorrector);
         PredictorCorrectorLoopToSolveBxBy(islice, current_N_level, step);
+        m_phase_timers.Stop(Phase::PredictorCorrector);
     }
 
     if (m_multi_beam.isSalameNow(step)) {
         // Modify the beam particle weights on this slice to flatten Ez.
         // As the beam current is modified, Bx and By are also recomputed.
+        m_phase_timers.Start(Phase::Salame);
         SalameModule(this, m_salame_n_iter, m_salame_do_advance, m_salame_last_slice,
                     m_salame_overloaded, current_N_level, step, islice, m_salame_relative_tolerance);
+        m_phase_timers.Stop(Phase::Salame);
     }
 
     // get beam diagnostics after SALAME but before beam push
-    m_multi_beam.InSituComputeDiags(step, islice, m_max_step, m_physical_time, m_max_time);
+    m_phase_timers.Start(Phase::InSituDiagnostics);
+    m_multi_beam.InSituComputeDiags(step, islice, m_output_max_step, m_physical_time, m_max_time);
+    m_phase_timers.Stop(Phase::InSituDiagnostics);
+    m_phase_timers.Start(Phase::OutputDiagnostics);
     FillBeamDiagnostics(step);
+    m_phase_timers.Stop(Phase::OutputDiagnostics);
 
     // get field insitu diagnostics after all fields are computed & SALAME
-    m_fields.InSituComputeDiags(step, m_physical_time, islice, m_3D_geom[0], m_max_step, m_max_time);
+    m_phase_timers.Start(Phase::InSituDiagnostics);
+    m_fields.InSituComputeDiags(step, m_physical_time, islice, m_output_max_step, m_max_time);
 
     // get laser insitu diagnostics
-    m_multi_laser.InSituComputeDiags(step, m_physical_time, islice, m_max_step, m_max_time);
+    m_multi_laser.InSituComputeDiags(step, m_physical_time, islice, m_output_max_step, m_max_time);
+    m_phase_timers.Stop(Phase::InSituDiagnostics);
 
     // copy fields (and laser) to diagnostic array
-    FillFieldDiagnostics(current_N_level, islice);
+    m_phase_timers.Start(Phase::OutputDiagnostics);
+    FillFieldDiagnostics(current_N_level, islice, step);
+    m_phase_timers.Stop(Phase::OutputDiagnostics);
 
     // plasma ionization
+    m_phase_timers.Start(Phase::Ionization);
     for (int lev=0; lev<current_N_level; ++lev) {
         m_multi_plasma.DoFieldIonization(lev, m_3D_geom[lev], m_fields);
     }
+    m_phase_timers.Stop(Phase::Ionization);
 
-    // Push plasma particles
+    // Push plasma particles, maybe also deposit the plasma currents of the next slice
+    const bool fused_deposit = m_fused_plasma_push_deposit &&
+        islice-1 >= m_3D_geom[0].Domain().smallEnd(2);
+    m_phase_timers.Start(Phase::PlasmaPush);
     for (int lev=0; lev<current_N_level; ++lev) {
-        m_multi_plasma.AdvanceParticles(m_fields, m_3D_geom, false, lev);
+        m_multi_plasma.AdvanceParticles(m_fields, m_3D_geom, false, lev, fused_deposit);
     }
+    m_phase_timers.Stop(Phase::PlasmaPush);
 
     // get minimum beam acceleration on level 0
     m_adaptive_time_step.GatherMinAccSlice(m_multi_beam, m_3D_geom[0], m_fields);
 
     // Push beam particles
+    m_phase_timers.Start(Phase::BeamPush);
     m_multi_beam.AdvanceBeamParticlesSlice(m_fields, m_3D_geom, islice, current_N_level);
+    m_phase_timers.Stop(Phase::BeamPush);
 
+    m_phase_timers.Start(Phase::BeamSlippage);
     m_multi_beam.shiftSlippedParticles(islice, m_3D_geom[0]);
+    m_phase_timers.Stop(Phase::BeamSlippage);
 
     // collisions for plasmas and beams
+    m_phase_timers.Start(Phase::Collisions);
     doCoulombCollision();
+    m_phase_timers.Stop(Phase::Collisions);
 
     // get minimum beam uz after push
     m_adaptive_time_step.GatherMinUzSlice(m_multi_beam, false);
 
-    bool is_last_step = (step == m_max_step) || (m_physical_time == m_max_time);
+    // get the beam centroid for the MR patches of the next time step
+    AccumulateMRPatchTracking();
+
+    bool is_last_step = (step == m_output_max_step) || (m_physical_time == m_max_time);
+    m_phase_timers.Start(Phase::MultiBufferSend);
     m_multi_buffer.put_data(islice, m_multi_beam, m_multi_laser, WhichBeamSlice::This, is_last_step);
+    m_phase_timers.Stop(Phase::MultiBufferSend);
 
     // shift all levels
-    for (int lev=0; lev<current_N_level; ++lev) {
-        m_fields.ShiftSlices(lev);
-    }
+    m_slice_graph.Run({2, current_N_level}, [&] () {
+        for (int lev=0; lev<current_N_level; ++lev) {
+            m_fields.ShiftSlices(lev);
+        }
+    });
 
     m_multi_beam.shiftBeamSlices();
 
@@ -791,7 +1085,7 @@ Hipace::InitializeSxSyWithBeam (const int lev)
 
 
 void
-Hipace::ExplicitMGSolveBxBy (const int lev, const int which_slice)
+Hipace::ExplicitMGSolveBxBy (const int lev, const int which_slice, const int islice)
 {
     HIPACE_PROFILE("Hipace::ExplicitMGSolveBxBy()");
 
@@ -906,7 +1200,19 @@ Hipace::ExplicitMGSolveBxBy (const int lev, const int which_slice)
         m_mlmg[lev]->solve({&BxBy}, {&SySx}, m_MG_tolerance_rel, m_MG_tolerance_abs);
     } else
 #endif
-    {
+    if (m_use_fft_bicgstab) {
+        if (m_fft_bicgstab.size()<m_N_level) {
+            m_fft_bicgstab.resize(m_N_level);
+        }
+        if (!m_fft_bicgstab[lev]) {
+            m_fft_bicgstab[lev] = std::make_unique<FFTBiCGStab>(slicemf.boxArray(),
+                                                                slicemf.DistributionMap(),
+                                                                m_slice_geom[lev]);
+        }
+        const int max_iters = 200;
+        m_fft_bicgstab[lev]->solve(BxBy[0], SySx[0], Mult[0], m_MG_tolerance_rel,
+                                   m_MG_tolerance_abs, max_iters, m_MG_verbose);
+    } else {
         AMREX_ALWAYS_ASSERT(slicemf.boxArray().size() == 1);
         if (m_hpmg.size()<m_N_level) {
             m_hpmg.resize(m_N_level);
@@ -915,6 +1221,12 @@ Hipace::ExplicitMGSolveBxBy (const int lev, const int which_slice)
             m_hpmg[lev] = std::make_unique<hpmg::MultiGrid>(m_slice_geom[lev].CellSize(0),
                                                             m_slice_geom[lev].CellSize(1),
                                                             slicemf.boxArray()[0], 1);
+            m_hpmg[lev]->set_warm_start(m_MG_warm_start);
+        }
+        // The SALAME slice only contains the contribution of the SALAME beam,
+        // so it is not correlated with the previous slices
+        if (which_slice == WhichSlice::This) {
+            m_hpmg[lev]->warm_start(BxBy[0], islice);
         }
         const int max_iters = 200;
         m_hpmg[lev]->solve1(BxBy[0], SySx[0], Mult[0], m_MG_tolerance_rel, m_MG_tolerance_abs,
@@ -953,6 +1265,9 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice, const int current_N
                                 WhichSlice::This,       {"Bx", "By"});
     }
 
+    // every slice starts a new Anderson history
+    if (m_predcorr_anderson_depth > 0) m_fields.AndersonResetBfields();
+
     // Begin of predictor corrector loop
     int i_iter = 0;
     // resetting the initial B-field error for mixing between iterations
@@ -991,10 +1306,20 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice, const int current_N
 
         if (i_iter == 1) relative_Bfield_error_prev_iter = relative_Bfield_error;
 
-        for (int lev=0; lev<current_N_level; ++lev) {
-            // Mixing the calculated B fields to the actual B field and shifting iterated B fields
-            m_fields.MixAndShiftBfields(relative_Bfield_error, relative_Bfield_error_prev_iter,
-                                        m_predcorr_B_mixing_factor, lev);
+        if (m_predcorr_anderson_depth > 0) {
+            // restart the acceleration if the extrapolation made the error grow significantly
+            if (relative_Bfield_error > 2. * relative_Bfield_error_prev_iter) {
+                m_fields.AndersonResetBfields();
+            }
+            // Anderson mixing of the calculated B fields for all levels at once,
+            // the iterated B fields are shifted afterwards
+            m_fields.AndersonMixBfields(m_3D_geom, current_N_level, m_predcorr_B_mixing_factor);
+        } else {
+            for (int lev=0; lev<current_N_level; ++lev) {
+                // Mixing the calculated B fields to the actual B field and shifting iterated B fields
+                m_fields.MixAndShiftBfields(relative_Bfield_error, relative_Bfield_error_prev_iter,
+                                            m_predcorr_B_mixing_factor, lev);
+            }
         }
 
         for (int lev=0; lev<current_N_level; ++lev) {
@@ -1026,6 +1351,10 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice, const int current_N
 
     // adding relative B field error for diagnostic
     m_predcorr_avg_B_error += relative_Bfield_error;
+    m_predcorr_max_used_iterations = std::max(m_predcorr_max_used_iterations, i_iter);
+    if (relative_Bfield_error > m_predcorr_B_error_tolerance && m_predcorr_B_error_tolerance > 0.) {
+        ++m_predcorr_unconverged_slices;
+    }
     if (m_verbose >= 2) amrex::Print() << "islice: " << islice <<
                 " n_iter: "<<i_iter<<" relative B field error: "<<relative_Bfield_error<< "\n";
 }
@@ -1034,30 +1363,57 @@ void
 Hipace::doCoulombCollision ()
 {
 
+    if (m_ncollisions == 0) return;
+    HIPACE_PROFILE("Hipace::doCoulombCollision()");
+
     // collisions for all particles calculated on level 0
     const int lev = 0;
+    const amrex::Box& bx = m_slice_geom[lev].Domain();
+
+    // Collisions only change the momentum, so every species is binned per cell once per slice
+    // and the bins are shared by all collisions it takes part in.
+    std::vector<PlasmaBins*> plasma_bins(m_multi_plasma.m_all_plasmas.size(), nullptr);
+    std::map<int, BeamBins> beam_bins;
+    auto get_plasma_bins = [&] (int idx) -> PlasmaBins& {
+        if (!plasma_bins[idx]) {
+            plasma_bins[idx] = &findParticlesInEachCell(
+                bx, m_multi_plasma.m_all_plasmas[idx], m_slice_geom[lev]);
+        }
+        return *plasma_bins[idx];
+    };
+    auto get_beam_bins = [&] (int idx) -> BeamBins& {
+        auto it = beam_bins.find(idx);
+        if (it == beam_bins.end()) {
+            it = beam_bins.emplace(idx, findBeamParticlesInEachCell(
+                bx, m_multi_beam.m_all_beams[idx], m_slice_geom[lev])).first;
+        }
+        return it->second;
+    };
 
     for (int i = 0; i < m_ncollisions; ++i)
     {
+        const int idx1 = m_all_collisions[i].m_species1_index;
+        const int idx2 = m_all_collisions[i].m_species2_index;
         if (m_all_collisions[i].m_nbeams == 1) {
             // do beam-plasma collisions
-            auto& species1 = m_multi_beam.m_all_beams[ m_all_collisions[i].m_species1_index ];
-            auto& species2 = m_multi_plasma.m_all_plasmas[ m_all_collisions[i].m_species2_index ];
+            auto& species1 = m_multi_beam.m_all_beams[idx1];
+            auto& species2 = m_multi_plasma.m_all_plasmas[idx2];
 
             // TODO: enable tiling
 
             CoulombCollision::doBeamPlasmaCoulombCollision(
-                lev, m_slice_geom[0].Domain(), m_slice_geom[0], species1, species2,
-                m_all_collisions[i].m_CoulombLog, m_background_density_SI);
+                lev, m_slice_geom[lev], species1, species2, get_beam_bins(idx1),
+                get_plasma_bins(idx2), m_all_collisions[i].m_CoulombLog, m_background_density_SI);
         } else {
             // do plasma-plasma collisions
-            auto& species1 = m_multi_plasma.m_all_plasmas[ m_all_collisions[i].m_species1_index ];
-            auto& species2 = m_multi_plasma.m_all_plasmas[ m_all_collisions[i].m_species2_index ];
+            auto& species1 = m_multi_plasma.m_all_plasmas[idx1];
+            auto& species2 = m_multi_plasma.m_all_plasmas[idx2];
 
             // TODO: enable tiling
 
             CoulombCollision::doPlasmaPlasmaCoulombCollision(
-                lev, m_slice_geom[0].Domain(), m_slice_geom[0], species1, species2, m_all_collisions[i].m_isSameSpecies,
+                lev, m_slice_geom[lev], species1, species2, get_plasma_bins(idx1),
+                get_plasma_bins(idx2), m_all_collisions[i].m_isSameSpecies,
                 m_all_collisions[i].m_CoulombLog, m_background_density_SI);
         }
     }
@@ -1068,32 +1424,41 @@ Hipace::InitDiagnostics (const int step)
 {
 #ifdef HIPACE_USE_OPENPMD
     // need correct physical time for this check
-    if (m_diags.hasAnyOutput(step, m_max_step, m_physical_time, m_max_time)) {
+    if (m_diags.hasAnyOutput(step, m_output_max_step, m_physical_time, m_max_time)) {
         m_openpmd_writer.InitDiagnostics();
     }
-    if (m_diags.hasBeamOutput(step, m_max_step, m_physical_time, m_max_time)) {
+    if (m_diags.hasBeamOutput(step, m_output_max_step, m_physical_time, m_max_time)) {
         m_openpmd_writer.InitBeamData(m_multi_beam, getDiagBeamNames());
     }
 #endif
     m_diags.ResizeFDiagFAB(m_3D_geom, m_multi_laser.GetLaserGeom(),
-                           step, m_max_step, m_physical_time, m_max_time);
+                           step, m_output_max_step, m_physical_time, m_max_time);
 }
 
 void
-Hipace::FillFieldDiagnostics (const int current_N_level, int islice)
+Hipace::FillFieldDiagnostics (const int current_N_level, int islice, const int step)
 {
     for (auto& fd : m_diags.getFieldData()) {
         if (fd.m_has_field) {
             m_fields.Copy(current_N_level, islice, fd, m_3D_geom, m_multi_laser);
+            if (fd.m_streaming.m_chunk_nz > 0) {
+                // hand finished z chunks to the IO right away
+                while (m_diags.PushStreamingChunk(fd, islice, m_3D_geom[0])) {
+#ifdef HIPACE_USE_OPENPMD
+                    m_openpmd_writer.WriteFieldChunk(fd, m_multi_laser, m_physical_time, step);
+#endif
+                }
+            }
         }
     }
+    amrex::ignore_unused(step);
 }
 
 void
 Hipace::FillBeamDiagnostics (const int step)
 {
 #ifdef HIPACE_USE_OPENPMD
-    if (m_diags.hasBeamOutput(step, m_max_step, m_physical_time, m_max_time)) {
+    if (m_diags.hasBeamOutput(step, m_output_max_step, m_physical_time, m_max_time)) {
         m_openpmd_writer.CopyBeams(m_multi_beam, getDiagBeamNames());
     }
 #else
@@ -1105,13 +1470,13 @@ void
 Hipace::WriteDiagnostics (const int step)
 {
 #ifdef HIPACE_USE_OPENPMD
-    if (m_diags.hasAnyFieldOutput(step, m_max_step, m_physical_time, m_max_time)) {
+    if (m_diags.hasAnyFieldOutput(step, m_output_max_step, m_physical_time, m_max_time)) {
         m_openpmd_writer.WriteDiagnostics(m_diags.getFieldData(), m_multi_beam,
                         m_multi_laser, m_physical_time, step, getDiagBeamNames(),
                         m_3D_geom, OpenPMDWriterCallType::fields);
     }
 
-    if (m_diags.hasBeamOutput(step, m_max_step, m_physical_time, m_max_time)) {
+    if (m_diags.hasBeamOutput(step, m_output_max_step, m_physical_time, m_max_time)) {
         m_openpmd_writer.WriteDiagnostics(m_diags.getFieldData(), m_multi_beam,
                         m_multi_laser, m_physical_time, step, getDiagBeamNames(),
                         m_3D_geom, OpenPMDWriterCallType::beams);
@@ -1126,6 +1491,6 @@ void
 Hipace::FlushDiagnostics ()
 {
 #ifdef HIPACE_USE_OPENPMD
-    m_openpmd_writer.flush();
+    m_openpmd_writer.flush(m_diags.getFieldData());
 #endif
 }
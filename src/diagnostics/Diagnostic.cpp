@@ -12,6 +12,7 @@
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
+#include <cstring>
 #include <map>
 #include <set>
 #include <string>
@@ -77,6 +78,15 @@ Diagnostic::Diagnostic (int nlev, bool use_laser)
 
         queryWithParser(pph, "output_period", fd.m_output_period);
         queryWithParserAlt(pp, "output_period", fd.m_output_period, ppd);
+
+        queryWithParserAlt(pp, "streaming_chunk_size", fd.m_streaming.m_chunk_nz, ppd);
+        queryWithParserAlt(pp, "streaming_host_buffers", fd.m_streaming.m_n_host_buffers, ppd);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fd.m_streaming.m_chunk_nz >= 0,
+            "streaming_chunk_size must be >= 0");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fd.m_streaming.m_n_host_buffers >= 1,
+            "streaming_host_buffers must be >= 1");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fd.m_streaming.m_chunk_nz == 0 || fd.m_slice_dir != 2,
+            "Streaming field output is not supported for xy_integrated diagnostics");
     }
 
     if (queryWithParser(pph, "output_period", m_beam_output_period)) {
@@ -181,6 +191,9 @@ Diagnostic::Initialize (int nlev, bool use_laser) {
         if (geometry_name_to_geom_type.count(base_geom_name) > 0) {
             fd.m_base_geom_type = geometry_name_to_geom_type.at(base_geom_name);
             fd.m_level = geometry_name_to_level.at(base_geom_name);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fd.m_streaming.m_chunk_nz == 0 ||
+                fd.m_base_geom_type == FieldDiagnosticData::geom_type::field,
+                "Streaming field output is not supported for the laser base_geometry");
         } else {
             amrex::Abort("Unknown diagnostics base_geometry: '" + base_geom_name + "'!\n" +
                          all_comps_error_str.str());
@@ -377,8 +390,23 @@ Diagnostic::ResizeFDiagFAB (amrex::Vector<amrex::Geometry>& field_geom,
             HIPACE_PROFILE("Diagnostic::ResizeFDiagFAB()");
             switch (fd.m_base_geom_type) {
                 case FieldDiagnosticData::geom_type::field:
-                    fd.m_F.resize(domain, fd.m_nfields, amrex::The_Pinned_Arena());
-                    fd.m_F.setVal<amrex::RunOn::Host>(0);
+                    if (fd.m_streaming.m_chunk_nz > 0) {
+                        // only keep a few z chunks of the diagnostic on the device at a time
+                        auto& sd = fd.m_streaming;
+                        fd.m_F.clear();
+                        sd.m_next_chunk_hi = domain.bigEnd(2);
+                        sd.m_current = 0;
+                        AllocateNextStreamingChunk(fd, sd.m_window[0]);
+                        AllocateNextStreamingChunk(fd, sd.m_window[1]);
+                        sd.m_window[2].clear();
+                        sd.m_host_ring.resize(sd.m_n_host_buffers);
+                        sd.m_ring_pos = 0;
+                        sd.m_span_chunks = 0;
+                        sd.m_dataset_initialized = false;
+                    } else {
+                        fd.m_F.resize(domain, fd.m_nfields, amrex::The_Pinned_Arena());
+                        fd.m_F.setVal<amrex::RunOn::Host>(0);
+                    }
                     break;
                 case FieldDiagnosticData::geom_type::laser:
                     fd.m_F_laser.resize(domain, fd.m_nfields, amrex::The_Pinned_Arena());
@@ -389,6 +417,69 @@ Diagnostic::ResizeFDiagFAB (amrex::Vector<amrex::Geometry>& field_geom,
     }
 }
 
+void
+Diagnostic::AllocateNextStreamingChunk (FieldDiagnosticData& fd, amrex::FArrayBox& fab)
+{
+    auto& sd = fd.m_streaming;
+    amrex::Box chunk = fd.m_geom_io.Domain();
+    chunk.setBig(2, sd.m_next_chunk_hi);
+    chunk.setSmall(2, std::max(chunk.smallEnd(2), sd.m_next_chunk_hi - sd.m_chunk_nz + 1));
+    sd.m_next_chunk_hi -= sd.m_chunk_nz;
+    if (chunk.ok()) {
+        fab.resize(chunk, fd.m_nfields, amrex::The_Arena());
+        fab.setVal<amrex::RunOn::Device>(0);
+    } else {
+        // below the diagnostic domain, an empty window receives no contributions
+        fab.clear();
+    }
+}
+
+bool
+Diagnostic::PushStreamingChunk (FieldDiagnosticData& fd, int islice,
+                                const amrex::Geometry& calc_geom)
+{
+    auto& sd = fd.m_streaming;
+    amrex::FArrayBox& window = sd.m_window[sd.m_current];
+
+    // all chunks of this diagnostic were already finished
+    if (!window.box().ok()) return false;
+
+    if (islice > calc_geom.Domain().smallEnd(2)) {
+        // highest diagnostic z cell that slice islice-1 can contribute to, same as in Fields::Copy
+        const amrex::Real poff_calc_z = GetPosOffset(2, calc_geom, calc_geom.Domain());
+        const amrex::Real poff_diag_z = GetPosOffset(2, fd.m_geom_io, fd.m_geom_io.Domain());
+        const amrex::Real pos_next_slice_max = islice * calc_geom.CellSize(2) + poff_calc_z;
+        const int k_max = static_cast<int>(amrex::Math::round((pos_next_slice_max - poff_diag_z)
+                                                              * fd.m_geom_io.InvCellSize(2)));
+        if (window.box().smallEnd(2) <= k_max) return false;
+    }
+
+    HIPACE_PROFILE("Diagnostic::PushStreamingChunk()");
+
+    // wait for Fields::Copy to finish writing into the window
+    amrex::Gpu::streamSynchronize();
+
+    amrex::Gpu::Device::setStreamIndex(FieldStreamingData::stream_index);
+    // the previous chunk has to be on the host before its window is reused below
+    amrex::Gpu::streamSynchronize();
+    amrex::FArrayBox& host_fab = sd.m_host_ring[sd.m_ring_pos];
+    host_fab.resize(window.box(), fd.m_nfields, amrex::The_Pinned_Arena());
+#ifdef AMREX_USE_GPU
+    amrex::Gpu::dtoh_memcpy_async(host_fab.dataPtr(), window.dataPtr(), window.nBytes());
+#else
+    std::memcpy(host_fab.dataPtr(), window.dataPtr(), window.nBytes());
+#endif
+    amrex::Gpu::Device::resetStreamIndex();
+
+    // rotate the windows: the next chunk gets filled, the window of the previous
+    // chunk that was copied to the host is used for the chunk after that
+    const int free_window = (sd.m_current + 2) % 3;
+    sd.m_current = (sd.m_current + 1) % 3;
+    AllocateNextStreamingChunk(fd, sd.m_window[free_window]);
+
+    return true;
+}
+
 void
 Diagnostic::TrimIOBox (int slice_dir, amrex::Box& domain_3d, amrex::RealBox& rbox_3d)
 {
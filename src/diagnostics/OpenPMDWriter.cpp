@@ -13,6 +13,10 @@
 #include "utils/IOUtil.H"
 #include "Hipace.H"
 
+#include <cstring>
+#include <exception>
+#include <utility>
+
 #ifdef HIPACE_USE_OPENPMD
 
 OpenPMDWriter::OpenPMDWriter ()
@@ -30,6 +34,17 @@ OpenPMDWriter::OpenPMDWriter ()
 #endif
     }
 
+    m_is_streaming = m_openpmd_backend == "sst";
+    if (m_is_streaming) {
+        queryWithParser(pp, "openpmd_sst_queue_limit", m_sst_queue_limit);
+        queryWithParser(pp, "openpmd_sst_queue_full_policy", m_sst_queue_full_policy);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_sst_queue_limit >= 1,
+            "hipace.openpmd_sst_queue_limit must be at least 1");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_sst_queue_full_policy == "discard" || m_sst_queue_full_policy == "block",
+            "hipace.openpmd_sst_queue_full_policy must be discard or block");
+    }
+
     // set default output path according to backend
     if (m_openpmd_backend == "h5") {
         m_file_prefix = "diags/hdf5";
@@ -37,6 +52,8 @@ OpenPMDWriter::OpenPMDWriter ()
         m_file_prefix = "diags/adios2";
     } else if (m_openpmd_backend == "json") {
         m_file_prefix = "diags/json";
+    } else if (m_openpmd_backend == "sst") {
+        m_file_prefix = "diags/sst";
     }
     // overwrite output path by choice of the user
     queryWithParser(pp, "file_prefix", m_file_prefix);
@@ -44,6 +61,82 @@ OpenPMDWriter::OpenPMDWriter ()
     // temporary workaround until openPMD-viewer gets fixed
     amrex::ParmParse ppd("diagnostic");
     queryWithParser(ppd, "openpmd_viewer_u_workaround", m_openpmd_viewer_workaround);
+
+    queryWithParser(ppd, "async_io", m_async_io);
+    queryWithParser(ppd, "async_io_max_in_flight", m_async_io_max_in_flight);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_async_io_max_in_flight >= 1,
+        "diagnostic.async_io_max_in_flight must be at least 1");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(m_async_io && m_is_streaming),
+        "diagnostic.async_io cannot be used with hipace.openpmd_backend = sst, "
+        "which does not block anyway");
+    if (m_async_io) {
+        m_io_thread = std::thread(&OpenPMDWriter::IOThreadLoop, this);
+    }
+}
+
+OpenPMDWriter::~OpenPMDWriter ()
+{
+    if (m_io_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_io_mutex);
+            m_io_stop = true;
+        }
+        m_io_cv.notify_all();
+        m_io_thread.join();
+        // errors of the output steps written after the last WaitForIO
+        CheckIOError();
+    }
+}
+
+void
+OpenPMDWriter::IOThreadLoop ()
+{
+    while (true) {
+        IOJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_io_mutex);
+            m_io_cv.wait(lock, [&] { return m_io_stop || !m_io_queue.empty(); });
+            if (m_io_queue.empty()) return;
+            job = std::move(m_io_queue.front());
+            m_io_queue.pop_front();
+            ++m_io_busy;
+        }
+
+        // the data is only read here, destroying the series closes the file
+        std::string error;
+        try {
+            job.m_series->flush();
+            job.m_series.reset();
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        job.m_buffers.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_io_mutex);
+            --m_io_busy;
+            if (!error.empty() && m_io_error.empty()) m_io_error = error;
+        }
+        m_io_cv.notify_all();
+    }
+}
+
+void
+OpenPMDWriter::CheckIOError ()
+{
+    if (!m_io_error.empty()) {
+        amrex::Abort("Error while writing openPMD output in the IO thread: " + m_io_error);
+    }
+}
+
+void
+OpenPMDWriter::WaitForIO ()
+{
+    if (!m_async_io) return;
+    HIPACE_PROFILE("OpenPMDWriter::WaitForIO()");
+    std::unique_lock<std::mutex> lock(m_io_mutex);
+    m_io_cv.wait(lock, [&] { return m_io_queue.empty() && m_io_busy == 0; });
+    CheckIOError();
 }
 
 void
@@ -51,6 +144,36 @@ OpenPMDWriter::InitDiagnostics ()
 {
     HIPACE_PROFILE("OpenPMDWriter::InitDiagnostics()");
 
+    if (m_is_streaming) {
+        // the stream is opened once and stays open until the end of the simulation
+        if (m_outputSeries) return;
+
+        // every rank computes different time steps, so every rank has its own stream
+        std::string filename = m_file_prefix + "/openpmd";
+        if (amrex::ParallelDescriptor::NProcs() > 1) {
+            filename += "_rank" + std::to_string(amrex::ParallelDescriptor::MyProc());
+        }
+        filename += ".sst";
+
+        // the simulation never waits for a reader to connect, and with the discard policy
+        // steps are dropped instead of waiting for a slow reader
+        const std::string config = R"({"adios2": {"engine": {"type": "sst", "parameters": {)"
+            R"("RendezvousReaderCount": "0", "QueueLimit": ")"
+            + std::to_string(m_sst_queue_limit) + R"(", "QueueFullPolicy": ")"
+            + (m_sst_queue_full_policy == "discard" ? "Discard" : "Block") + R"("}}}})";
+
+        m_outputSeries = std::make_unique< openPMD::Series >(
+            filename, openPMD::Access::CREATE, config);
+        return;
+    }
+
+    if (m_openpmd_backend != "json") {
+        // HDF5 and ADIOS2 are in general not thread-safe, so the IO thread can't write
+        // while a new series is opened and written. The JSON backend only uses the
+        // C++ streams of its own series, so series can be written from both threads
+        WaitForIO();
+    }
+
     std::string filename = m_file_prefix + "/openpmd_%06T." + m_openpmd_backend;
 
     m_outputSeries = std::make_unique< openPMD::Series >(
@@ -59,6 +182,17 @@ OpenPMDWriter::InitDiagnostics ()
     // TODO: meta-data: author, mesh path, extensions, software
 }
 
+openPMD::Iteration
+OpenPMDWriter::GetIteration (int output_step)
+{
+    if (m_is_streaming) {
+        // iterations have to be written in order, one engine step each
+        m_open_iteration = output_step;
+        return m_outputSeries->writeIterations()[output_step];
+    }
+    return m_outputSeries->iterations[output_step];
+}
+
 void
 OpenPMDWriter::WriteDiagnostics (
     const amrex::Vector<FieldDiagnosticData>& field_diag, MultiBeam& a_multi_beam,
@@ -67,23 +201,70 @@ OpenPMDWriter::WriteDiagnostics (
     amrex::Vector<amrex::Geometry> const& geom3D,
     const OpenPMDWriterCallType call_type)
 {
-    openPMD::Iteration iteration = m_outputSeries->iterations[output_step];
+    openPMD::Iteration iteration = GetIteration(output_step);
     iteration.setTime(physical_time);
 
     if (call_type == OpenPMDWriterCallType::beams ) {
         WriteBeamParticleData(a_multi_beam, iteration, geom3D[0], beamnames);
     } else if (call_type == OpenPMDWriterCallType::fields) {
         for (const auto& fd : field_diag) {
-            if (fd.m_has_field) {
+            // streamed diagnostics were already written chunk by chunk
+            if (fd.m_has_field && fd.m_streaming.m_chunk_nz == 0) {
                 WriteFieldData(fd, a_multi_laser, iteration);
             }
         }
     }
 }
 
+void
+OpenPMDWriter::WriteFieldChunk (FieldDiagnosticData& fd, const MultiLaser& a_multi_laser,
+                                const amrex::Real physical_time, const int output_step)
+{
+    HIPACE_PROFILE("OpenPMDWriter::WriteFieldChunk()");
+
+    auto& sd = fd.m_streaming;
+    openPMD::Iteration iteration = GetIteration(output_step);
+    if (!sd.m_dataset_initialized) {
+        iteration.setTime(physical_time);
+    }
+
+    if (m_openpmd_backend == "bp") {
+        // ADIOS2 provides the memory for the chunk, so the host buffer can be reused right away
+        FieldStreamingData::synchronize();
+        WriteFieldData(fd, a_multi_laser, iteration, &sd.m_host_ring[sd.m_ring_pos],
+                       !sd.m_dataset_initialized, true);
+        sd.m_dataset_initialized = true;
+
+        ++sd.m_span_chunks;
+        if (sd.m_span_chunks == static_cast<int>(sd.m_host_ring.size())) {
+            // write the engine buffer to disk to keep its memory usage constant
+            WaitForIO();
+            m_outputSeries->flush(R"({"adios2": {"engine": {"preferred_flush_target": "disk"}}})");
+            sd.m_span_chunks = 0;
+        }
+        return;
+    }
+
+    // not read until the data is flushed
+    WriteFieldData(fd, a_multi_laser, iteration, &sd.m_host_ring[sd.m_ring_pos],
+                   !sd.m_dataset_initialized);
+    sd.m_dataset_initialized = true;
+
+    ++sd.m_ring_pos;
+    if (sd.m_ring_pos == static_cast<int>(sd.m_host_ring.size())) {
+        // all host buffers are in use, write them to file so they can be reused
+        FieldStreamingData::synchronize();
+        // don't write from two threads at the same time
+        WaitForIO();
+        m_outputSeries->flush();
+        sd.m_ring_pos = 0;
+    }
+}
+
 void
 OpenPMDWriter::WriteFieldData (
-    const FieldDiagnosticData& fd, const MultiLaser& a_multi_laser, openPMD::Iteration iteration)
+    const FieldDiagnosticData& fd, const MultiLaser& a_multi_laser, openPMD::Iteration iteration,
+    const amrex::FArrayBox* chunk, bool setup_dataset, bool use_span)
 {
     HIPACE_PROFILE("OpenPMDWriter::WriteFieldData()");
 
@@ -104,7 +285,8 @@ OpenPMDWriter::WriteFieldData (
         field.setDataOrder(openPMD::Mesh::DataOrder::C);
 
         const amrex::Geometry& geom = fd.m_geom_io;
-        const amrex::Box data_box = is_laser_comp ? fd.m_F_laser.box() : fd.m_F.box();
+        const amrex::FArrayBox& field_fab = chunk ? *chunk : fd.m_F;
+        const amrex::Box data_box = is_laser_comp ? fd.m_F_laser.box() : field_fab.box();
 
         // node staggering, labels, spacing and offsets
         // convert AMReX Fortran index order to C order
@@ -128,17 +310,19 @@ OpenPMDWriter::WriteFieldData (
             chunk_offset.erase(chunk_offset.begin() + remove_dir);
             chunk_size.erase(chunk_size.begin() + remove_dir);
         }
-        field_comp.setPosition(relative_cell_pos);
-        field.setAxisLabels(axisLabels);
-        field.setGridSpacing(dCells);
-        field.setGridGlobalOffset(offWindow);
-
-        openPMD::Datatype datatype = is_laser_comp ?
-            openPMD::determineDatatype< std::complex<amrex::Real> >() :
-            openPMD::determineDatatype< amrex::Real >();
-        // set data type and global size of the simulation
-        openPMD::Dataset dataset(datatype, global_size);
-        field_comp.resetDataset(dataset);
+        if (setup_dataset) {
+            field_comp.setPosition(relative_cell_pos);
+            field.setAxisLabels(axisLabels);
+            field.setGridSpacing(dCells);
+            field.setGridGlobalOffset(offWindow);
+
+            openPMD::Datatype datatype = is_laser_comp ?
+                openPMD::determineDatatype< std::complex<amrex::Real> >() :
+                openPMD::determineDatatype< amrex::Real >();
+            // set data type and global size of the simulation
+            openPMD::Dataset dataset(datatype, global_size);
+            field_comp.resetDataset(dataset);
+        }
 
         if (is_laser_comp) {
             // set laser attributes and store laser
@@ -150,8 +334,12 @@ OpenPMDWriter::WriteFieldData (
             field_comp.storeChunkRaw(
                 reinterpret_cast<const std::complex<amrex::Real>*>(fd.m_F_laser.dataPtr()),
                 chunk_offset, chunk_size);
+        } else if (use_span) {
+            auto span = field_comp.storeChunk<amrex::Real>(chunk_offset, chunk_size);
+            std::memcpy(span.currentBuffer().data(), field_fab.dataPtr(icomp),
+                        field_fab.box().numPts() * sizeof(amrex::Real));
         } else {
-            field_comp.storeChunkRaw(fd.m_F.dataPtr(icomp), chunk_offset, chunk_size);
+            field_comp.storeChunkRaw(field_fab.dataPtr(icomp), chunk_offset, chunk_size);
         }
     }
 }
@@ -428,12 +616,48 @@ OpenPMDWriter::SetupRealProperties (openPMD::ParticleSpecies& currSpecies,
     } // end for NumSoARealAttributes
 }
 
-void OpenPMDWriter::flush ()
+void OpenPMDWriter::flush (amrex::Vector<FieldDiagnosticData>& field_diag)
 {
     amrex::Gpu::streamSynchronize();
+    FieldStreamingData::synchronize();
+    // the beam data is kept alive by openPMD until it is flushed
     m_uint64_beam_data.resize(0);
     m_real_beam_data.resize(0);
-    if (m_outputSeries) {
+    if (m_is_streaming) {
+        if (m_open_iteration >= 0) {
+            HIPACE_PROFILE("OpenPMDWriter::flush()");
+            // end the engine step, the series stays open for the next output step
+            m_outputSeries->writeIterations()[m_open_iteration].close();
+            m_open_iteration = -1;
+        }
+        return;
+    }
+    if (m_outputSeries && m_async_io) {
+        HIPACE_PROFILE("OpenPMDWriter::flush()");
+        IOJob job;
+        job.m_series = std::move(m_outputSeries);
+        // move the host buffers of the field diagnostics to the IO thread,
+        // they are allocated again in the next output step
+        for (auto& fd : field_diag) {
+            if (!fd.m_has_field) continue;
+            job.m_buffers.push_back(std::make_shared<amrex::FArrayBox>(std::move(fd.m_F)));
+            job.m_buffers.push_back(std::make_shared<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
+                std::move(fd.m_F_laser)));
+            for (auto& fab : fd.m_streaming.m_host_ring) {
+                job.m_buffers.push_back(std::make_shared<amrex::FArrayBox>(std::move(fab)));
+            }
+        }
+        {
+            // limit the number of output steps in flight
+            std::unique_lock<std::mutex> lock(m_io_mutex);
+            m_io_cv.wait(lock, [&] {
+                return static_cast<int>(m_io_queue.size()) + m_io_busy < m_async_io_max_in_flight;
+            });
+            CheckIOError();
+            m_io_queue.push_back(std::move(job));
+        }
+        m_io_cv.notify_all();
+    } else if (m_outputSeries) {
         HIPACE_PROFILE("OpenPMDWriter::flush()");
         m_outputSeries->flush();
     }
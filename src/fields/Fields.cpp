@@ -38,6 +38,7 @@ Fields::Fields (const int nlev)
     m_poisson_solver_str = "FFTDirichletDirect";
 #endif
     queryWithParser(ppf, "poisson_solver", m_poisson_solver_str);
+    queryWithParser(ppf, "batched_poisson_solve", m_batched_poisson_solve);
     queryWithParser(ppf, "insitu_period", m_insitu_period);
     queryWithParser(ppf, "insitu_file_prefix", m_insitu_file_prefix);
     queryWithParser(ppf, "do_symmetrize", m_do_symmetrize);
@@ -75,6 +76,13 @@ Fields::AllocData (
 
             int isl = WhichSlice::Next;
             Comps[isl].multi_emplace(N_Comps, "jx_beam", "jy_beam");
+            if (Hipace::m_fused_plasma_push_deposit) {
+                // plasma currents deposited in the plasma push
+                Comps[isl].multi_emplace(N_Comps, "jx", "jy", "chi", "rhomjz");
+                if (Hipace::m_deposit_rho) {
+                    Comps[isl].multi_emplace(N_Comps, "rho");
+                }
+            }
 
             isl = WhichSlice::This;
             // (Bx, By), (Sy, Sx) and (chi, chi2) adjacent for explicit solver
@@ -112,6 +120,10 @@ Fields::AllocData (
             if (any_salame) {
                 Comps[isl].multi_emplace(N_Comps, "Ez_target", "Ez_no_salame", "Ez",
                     "jx", "jy", "jz_beam", "Bx", "By", "Sy", "Sx", "Sy_back", "Sx_back");
+                if (Hipace::GetInstance().m_salame_sub_box_guard >= 0) {
+                    // boundary values for the cropped SALAME solves
+                    Comps[isl].multi_emplace(N_Comps, "Ez_only_salame");
+                }
             }
 
             isl = WhichSlice::PCIter;
@@ -173,6 +185,32 @@ Fields::AllocData (
         m_slices[lev].setVal(0._rt);
     }
 
+    if (!m_explicit && Hipace::m_predcorr_anderson_depth > 0) {
+        if (lev==0) m_anderson_history.resize(m_slices.size());
+        m_anderson_history[lev].define(
+            slice_ba, slice_dm, 6 + 4 * Hipace::m_predcorr_anderson_depth, m_slices_nguards,
+            amrex::MFInfo().SetArena(amrex::The_Arena()));
+        m_anderson_history[lev].setVal(0._rt);
+    }
+
+    if (Hipace::m_verbose >= 1) {
+        // every WhichSlice only holds the components it needs, print them to keep track of that
+        const char* slice_names[WhichSlice::N] = {"Next", "This", "Previous", "RhomJzIons",
+                                                  "Salame", "PCIter", "PCPrevIter"};
+        amrex::Print() << "Level " << lev << ": " << N_Comps << " field components with "
+                       << amrex::grow(slice_ba[0], m_slices_nguards).d_numPts() * N_Comps
+                          * sizeof(amrex::Real) / (1024.*1024.)
+                       << " MiB of slice memory in total on this level\n";
+        for (int isl=0; isl<WhichSlice::N; ++isl) {
+            if (Comps[isl].empty()) continue;
+            amrex::Print() << "    " << slice_names[isl] << ":";
+            for (auto& [name, idx] : Comps[isl]) {
+                amrex::Print() << " " << name;
+            }
+            amrex::Print() << "\n";
+        }
+    }
+
     // The Poisson solver operates on transverse slices only.
     // The constructor takes the BoxArray and the DistributionMap of a slice,
     // so the FFTPlans are built on a slice.
@@ -187,10 +225,12 @@ Fields::AllocData (
                                                   getSlices(lev).DistributionMap(),
                                                   geom)) );
     } else if (m_poisson_solver_str == "FFTDirichletFast"){
+        // Psi, Ez and Bz are solved together
+        const int max_batch_size = m_batched_poisson_solve ? 3 : 1;
         m_poisson_solver.push_back(std::unique_ptr<FFTPoissonSolverDirichletFast>(
             new FFTPoissonSolverDirichletFast(getSlices(lev).boxArray(),
                                               getSlices(lev).DistributionMap(),
-                                              geom)) );
+                                              geom, max_batch_size)) );
     } else if (m_poisson_solver_str == "FFTPeriodic") {
         m_poisson_solver.push_back(std::unique_ptr<FFTPoissonSolverPeriodic>(
             new FFTPoissonSolverPeriodic(getSlices(lev).boxArray(),
@@ -216,6 +256,7 @@ Fields::AllocData (
         // Allocate memory for in-situ diagnostics
         m_insitu_rdata.resize(geom.Domain().length(2)*m_insitu_nrp, 0.);
         m_insitu_sum_rdata.resize(m_insitu_nrp, 0.);
+        m_insitu_acc.resize(geom.Domain().length(2));
     }
 }
 
@@ -504,16 +545,29 @@ Fields::Copy (const int current_N_level, const int i_slice, FieldDiagnosticData&
 
         if (fd.m_base_geom_type == FieldDiagnosticData::geom_type::field &&
             current_N_level > fd.m_level) {
+            // When streaming, this slice can contribute to the current and the next z chunk.
+            // Slices never reach further than one chunk down as they touch at most one
+            // diagnostic cell with non-zero weight.
+            amrex::FArrayBox* diag_fabs[2] = {&fd.m_F, nullptr};
+            if (fd.m_streaming.m_chunk_nz > 0) {
+                diag_fabs[0] = &fd.m_streaming.m_window[fd.m_streaming.m_current];
+                diag_fabs[1] = &fd.m_streaming.m_window[(fd.m_streaming.m_current + 1) % 3];
+            }
             auto slice_array = slice_func.array(mfi);
-            amrex::Array4<amrex::Real> diag_array = fd.m_F.array();
-            amrex::ParallelFor(diag_box, fd.m_nfields,
-                [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept
-                {
-                    const amrex::Real x = i * dx + poff_diag_x;
-                    const amrex::Real y = j * dy + poff_diag_y;
-                    const int m = n[diag_comps];
-                    diag_array(i,j,k,n) += rel_z_data[k-k_min] * slice_array(x,y,m);
-                });
+            for (amrex::FArrayBox* diag_fab : diag_fabs) {
+                if (diag_fab == nullptr) continue;
+                const amrex::Box fab_diag_box = diag_box & diag_fab->box();
+                if (fab_diag_box.isEmpty()) continue;
+                amrex::Array4<amrex::Real> diag_array = diag_fab->array();
+                amrex::ParallelFor(fab_diag_box, fd.m_nfields,
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept
+                    {
+                        const amrex::Real x = i * dx + poff_diag_x;
+                        const amrex::Real y = j * dy + poff_diag_y;
+                        const int m = n[diag_comps];
+                        diag_array(i,j,k,n) += rel_z_data[k-k_min] * slice_array(x,y,m);
+                    });
+            }
         } else if (fd.m_base_geom_type == FieldDiagnosticData::geom_type::laser &&
                    multi_laser.UseLaser(i_slice)) {
             auto laser_array = laser_func.array(mfi);
@@ -583,6 +637,25 @@ Fields::InitializeSlices (int lev, int islice, const amrex::Vector<amrex::Geomet
             setVal(0., lev, WhichSlice::This, "rho_" + plasma_name);
         }
     }
+    if (Hipace::m_explicit && Hipace::m_fused_plasma_push_deposit) {
+        // the plasma currents of this slice were deposited during the plasma push
+        // of the previous slice
+        add(lev, WhichSlice::This, {"jx", "jy", "chi", "rhomjz"},
+                 WhichSlice::Next, {"jx", "jy", "chi", "rhomjz"});
+        setVal(0., lev, WhichSlice::Next, "jx", "jy", "chi", "rhomjz");
+        if (Hipace::m_deposit_rho) {
+            add(lev, WhichSlice::This, {"rho"}, WhichSlice::Next, {"rho"});
+            setVal(0., lev, WhichSlice::Next, "rho");
+        }
+    }
+}
+
+bool
+Fields::SupportsGPUGraphs () const
+{
+    return m_poisson_solver_str != "MGDirichlet" &&
+           !m_lev0_periodicity.isAnyPeriodic() &&
+           Hipace::m_boundary_field != FieldBoundary::Open;
 }
 
 void
@@ -614,6 +687,67 @@ Fields::AddRhoIons (const int lev)
     }
 }
 
+/** \brief Maps an index along the edge of a box to the boundary cell of RHS, the position at
+ * which the boundary value is needed and the cell size used in the Laplacian across the edge.
+ * For i_edge in [0, size()), every cell on the edge of the box is visited once, except for the
+ * corners which are visited twice.
+ */
+struct BoxEdge
+{
+    int box_len0, box_len1, box_lo0, box_lo1;
+    amrex::Real dx, dy, offset0, offset1, offset;
+
+    /** \brief Constructor
+     *
+     * \param[in] solver_size size of RHS/poisson solver (no tiling)
+     * \param[in] geom geometry of of RHS/poisson solver
+     * \param[in] a_offset shift boundary position by offset number of cells
+     */
+    BoxEdge (const amrex::Box& solver_size, const amrex::Geometry& geom, const amrex::Real a_offset)
+        : box_len0{solver_size.length(0)}, box_len1{solver_size.length(1)},
+          box_lo0{solver_size.smallEnd(0)}, box_lo1{solver_size.smallEnd(1)},
+          dx{geom.CellSize(0)}, dy{geom.CellSize(1)},
+          offset0{GetPosOffset(0, geom, solver_size)}, offset1{GetPosOffset(1, geom, solver_size)},
+          offset{a_offset} {}
+
+    /** \brief number of indices along the edge */
+    int size () const { return 2 * (box_len0 + box_len1); }
+
+    /** \brief get the boundary cell for index i_edge
+     *
+     * \param[in] i_edge index along the edge
+     * \param[out] i_idx x index of the boundary cell in RHS
+     * \param[out] j_idx y index of the boundary cell in RHS
+     * \param[out] x x position where the boundary value is needed
+     * \param[out] y y position where the boundary value is needed
+     * \param[out] dxdx square of the cell size across the edge
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void operator() (const int i_edge, int& i_idx, int& j_idx,
+                     amrex::Real& x, amrex::Real& y, amrex::Real& dxdx) const noexcept
+    {
+        const int i = i_edge % (box_len0 + box_len1);
+        const int j = i_edge / (box_len0 + box_len1);
+
+        const bool i_is_changing = (i < box_len0);
+        const bool i_lo_edge = (!i_is_changing) && (!j);
+        const bool i_hi_edge = (!i_is_changing) && j;
+        const bool j_lo_edge = i_is_changing && (!j);
+        const bool j_hi_edge = i_is_changing && j;
+
+        i_idx = box_lo0 + i_hi_edge*(box_len0-1) + i_is_changing*i;
+        j_idx = box_lo1 + j_hi_edge*(box_len1-1) + (!i_is_changing)*(i-box_len0);
+
+        const amrex::Real i_idx_offset = i_idx + (- i_lo_edge + i_hi_edge) * offset;
+        const amrex::Real j_idx_offset = j_idx + (- j_lo_edge + j_hi_edge) * offset;
+
+        x = i_idx_offset * dx + offset0;
+        y = j_idx_offset * dy + offset1;
+
+        dxdx = dx*dx*(!i_is_changing) + dy*dy*i_is_changing;
+    }
+};
+
 /** \brief Sets non zero Dirichlet Boundary conditions in RHS which is the source of the Poisson
  * equation: laplace LHS = RHS
  *
@@ -636,37 +770,15 @@ SetDirichletBoundaries (Array2<amrex::Real> RHS, const amrex::Box& solver_size,
     // This follows Van Loan, C. (1992). Computational frameworks for the fast Fourier transform.
     // Page 254 ff.
     // The interpolation is done in second order transversely and linearly in longitudinal direction
-    const int box_len0 = solver_size.length(0);
-    const int box_len1 = solver_size.length(1);
-    const int box_lo0 = solver_size.smallEnd(0);
-    const int box_lo1 = solver_size.smallEnd(1);
-    const amrex::Real dx = geom.CellSize(0);
-    const amrex::Real dy = geom.CellSize(1);
-    const amrex::Real offset0 = GetPosOffset(0, geom, solver_size);
-    const amrex::Real offset1 = GetPosOffset(1, geom, solver_size);
-
-    const amrex::Box edge_box = {{0, 0, 0}, {box_len0 + box_len1 - 1, 1, 0}};
+    const BoxEdge edge {solver_size, geom, offset};
 
     // ParallelFor only over the edge of the box
-    amrex::ParallelFor(to2D(edge_box),
-        [=] AMREX_GPU_DEVICE (int i, int j) noexcept
+    amrex::ParallelFor(edge.size(),
+        [=] AMREX_GPU_DEVICE (int i_edge) noexcept
         {
-            const bool i_is_changing = (i < box_len0);
-            const bool i_lo_edge = (!i_is_changing) && (!j);
-            const bool i_hi_edge = (!i_is_changing) && j;
-            const bool j_lo_edge = i_is_changing && (!j);
-            const bool j_hi_edge = i_is_changing && j;
-
-            const int i_idx = box_lo0 + i_hi_edge*(box_len0-1) + i_is_changing*i;
-            const int j_idx = box_lo1 + j_hi_edge*(box_len1-1) + (!i_is_changing)*(i-box_len0);
-
-            const amrex::Real i_idx_offset = i_idx + (- i_lo_edge + i_hi_edge) * offset;
-            const amrex::Real j_idx_offset = j_idx + (- j_lo_edge + j_hi_edge) * offset;
-
-            const amrex::Real x = i_idx_offset * dx + offset0;
-            const amrex::Real y = j_idx_offset * dy + offset1;
-
-            const amrex::Real dxdx = dx*dx*(!i_is_changing) + dy*dy*i_is_changing;
+            int i_idx = 0, j_idx = 0;
+            amrex::Real x = 0._rt, y = 0._rt, dxdx = 0._rt;
+            edge(i_edge, i_idx, j_idx, x, y, dxdx);
 
             // atomic add because the corners of RHS get two values
             amrex::Gpu::Atomic::AddNoRet(&(RHS(i_idx, j_idx)),
@@ -674,71 +786,128 @@ SetDirichletBoundaries (Array2<amrex::Real> RHS, const amrex::Box& solver_size,
         });
 }
 
+template<int ncomp>
 void
-Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const int lev,
-                              const int which_slice, std::string component,
-                              amrex::MultiFab&& staging_area,
-                              amrex::Real offset, amrex::Real factor)
+Fields::SetOpenBoundaryCondition (const amrex::Geometry& geom,
+                                  const std::array<std::string, ncomp>& components,
+                                  amrex::MultiFab& staging_area,
+                                  amrex::Real offset, amrex::Real factor)
 {
-    const amrex::Box staging_box = geom[lev].Domain();
-
-    if (lev == 0 && Hipace::m_boundary_field == FieldBoundary::Open) {
-        HIPACE_PROFILE("Fields::SetOpenBoundaryCondition()");
-        // Coarsest level: use Taylor expansion of the Green's function
-        // to get Dirichlet boundary conditions
-
-        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(staging_area.size() == 1,
-            "Open Boundaries only work for lev0 with everything in one box");
-        amrex::FArrayBox& staging_area_fab = staging_area[0];
-
-        const Array2<amrex::Real> arr_staging_area = staging_area_fab.array();
-
-        const amrex::Real poff_x = GetPosOffset(0, geom[lev], staging_box);
-        const amrex::Real poff_y = GetPosOffset(1, geom[lev], staging_box);
-        const amrex::Real dx = geom[lev].CellSize(0);
-        const amrex::Real dy = geom[lev].CellSize(1);
-        // scale factor cancels out for all multipole coefficients except the 0th, for wich it adds
-        // a constant term to the potential
-        const amrex::Real scale = 3._rt/std::sqrt(
-            pow<2>(geom[lev].ProbLength(0)) + pow<2>(geom[lev].ProbLength(1)));
-        const amrex::Real radius = amrex::min(
-            std::abs(geom[lev].ProbLo(0)), std::abs(geom[lev].ProbHi(0)),
-            std::abs(geom[lev].ProbLo(1)), std::abs(geom[lev].ProbHi(1)));
-        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(radius > 0._rt, "The x=0, y=0 coordinate must be inside"
-            "the simulation box as it is used as the point of expansion for open boundaries");
-        // ignore everything outside of 95% the min radius as the Taylor expansion only converges
-        // outside of a circular patch containing the sources, i.e. the sources can't be further
-        // from the center than the closest boundary as it would be the case in the corners
-        const amrex::Real cutoff_sq = pow<2>(0.95_rt * radius * scale);
+    HIPACE_PROFILE("Fields::SetOpenBoundaryCondition()");
+    // Coarsest level: use Taylor expansion of the Green's function
+    // to get Dirichlet boundary conditions
+    constexpr int nc = n_multipole_coeffs;
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(staging_area.size() == 1,
+        "Open Boundaries only work for lev0 with everything in one box");
+    AMREX_ALWAYS_ASSERT(staging_area.nComp() >= ncomp);
+    const amrex::Box staging_box = geom.Domain();
+    const Array3<const amrex::Real> arr_staging_area = staging_area.const_array(0);
+
+    const amrex::Real poff_x = GetPosOffset(0, geom, staging_box);
+    const amrex::Real poff_y = GetPosOffset(1, geom, staging_box);
+    const amrex::Real dx = geom.CellSize(0);
+    const amrex::Real dy = geom.CellSize(1);
+    // scale factor cancels out for all multipole coefficients except the 0th, for wich it adds
+    // a constant term to the potential
+    const amrex::Real scale = 3._rt/std::sqrt(
+        pow<2>(geom.ProbLength(0)) + pow<2>(geom.ProbLength(1)));
+    const amrex::Real radius = amrex::min(
+        std::abs(geom.ProbLo(0)), std::abs(geom.ProbHi(0)),
+        std::abs(geom.ProbLo(1)), std::abs(geom.ProbHi(1)));
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(radius > 0._rt, "The x=0, y=0 coordinate must be inside"
+        "the simulation box as it is used as the point of expansion for open boundaries");
+    // ignore everything outside of 95% the min radius as the Taylor expansion only converges
+    // outside of a circular patch containing the sources, i.e. the sources can't be further
+    // from the center than the closest boundary as it would be the case in the corners
+    const amrex::Real cutoff_sq = pow<2>(0.95_rt * radius * scale);
+
+    // The Taylor expansion terms of the Green's function at the boundary only depend on the
+    // geometry, so they are computed once and stored as a matrix of size n_edge x nc
+    const BoxEdge edge {staging_box, geom, offset};
+    const int n_edge = edge.size();
+    std::vector<amrex::Real> key {
+        amrex::Real(staging_box.smallEnd(0)), amrex::Real(staging_box.smallEnd(1)),
+        amrex::Real(staging_box.bigEnd(0)), amrex::Real(staging_box.bigEnd(1)),
+        geom.ProbLo(0), geom.ProbLo(1), geom.ProbHi(0), geom.ProbHi(1), offset};
+    if (key != m_open_boundary_terms_key) {
+        HIPACE_PROFILE("Fields::OpenBoundaryTerms()");
+        m_open_boundary_terms.resize(std::size_t(n_edge) * nc);
+        amrex::Real * const terms = m_open_boundary_terms.dataPtr();
         const amrex::Real dxdy_div_4pi = dx*dy/(4._rt * MathConst::pi);
-
-        MultipoleTuple coeff_tuple =
-        amrex::ParReduce(MultipoleReduceOpList{}, MultipoleReduceTypeList{},
-                         staging_area,
-            [=] AMREX_GPU_DEVICE (int /*box_num*/, int i, int j, int) noexcept
+        amrex::ParallelFor(n_edge,
+            [=] AMREX_GPU_DEVICE (int i_edge) noexcept
             {
-                const amrex::Real x = (i * dx + poff_x) * scale;
-                const amrex::Real y = (j * dy + poff_y) * scale;
-                if (x*x + y*y > cutoff_sq)  {
-                    return amrex::IdentityTuple(MultipoleTuple{}, MultipoleReduceOpList{});
-                }
-                amrex::Real s_v = arr_staging_area(i, j);
-                return GetMultipoleCoeffs(s_v, x, y);
-            }
-        );
+                int i_idx = 0, j_idx = 0;
+                amrex::Real x = 0._rt, y = 0._rt, dxdx = 0._rt;
+                edge(i_edge, i_idx, j_idx, x, y, dxdx);
+                const MultipoleTuple t = GetFieldMultipoleTerms(x*scale, y*scale);
+                amrex::constexpr_for<0, nc>([&] (auto k) {
+                    terms[k*n_edge + i_edge] = dxdy_div_4pi * amrex::get<k>(t) / dxdx;
+                });
+            });
+        m_open_boundary_terms_key = std::move(key);
+    }
 
-        if (component == "Ez" || component == "Bz") {
+    // get the multipole coefficients of all sources in one pass over the slice
+    const MultipoleTupleN<ncomp> coeff_tuple =
+    amrex::ParReduce(MultipoleReduceOpListN<ncomp>{}, MultipoleReduceTypeListN<ncomp>{},
+                     staging_area,
+        [=] AMREX_GPU_DEVICE (int /*box_num*/, int i, int j, int) noexcept
+        {
+            const amrex::Real x = (i * dx + poff_x) * scale;
+            const amrex::Real y = (j * dy + poff_y) * scale;
+            if (x*x + y*y > cutoff_sq)  {
+                return amrex::IdentityTuple(MultipoleTupleN<ncomp>{},
+                                            MultipoleReduceOpListN<ncomp>{});
+            }
+            return GetMultipoleCoeffsN<ncomp>(
+                [&] (int n) { return arr_staging_area(i, j, n); }, x, y);
+        }
+    );
+
+    amrex::GpuArray<amrex::Real, nc*ncomp> coeffs;
+    amrex::constexpr_for<0, nc*ncomp>([&] (auto k) {
+        coeffs[k] = amrex::get<k>(coeff_tuple);
+    });
+    for (int n = 0; n < ncomp; ++n) {
+        if (components[n] == "Ez" || components[n] == "Bz") {
             // Because Ez and Bz only have transverse derivatives of currents as sources, the
             // integral over the whole box is zero, meaning they have no physical monopole component
-            amrex::get<0>(coeff_tuple) = 0._rt;
+            coeffs[n*nc] = 0._rt;
         }
+    }
 
-        SetDirichletBoundaries(arr_staging_area, staging_box, geom[lev], offset, factor,
-            [=] AMREX_GPU_DEVICE (amrex::Real x, amrex::Real y) noexcept
-            {
-                return dxdy_div_4pi*GetFieldMultipole(coeff_tuple, x*scale, y*scale);
+    // evaluate the expansion at the boundary for all sources: one matrix-vector product each
+    const Array3<amrex::Real> arr_rhs = staging_area.array(0);
+    const amrex::Real * const terms = m_open_boundary_terms.dataPtr();
+    amrex::ParallelFor(n_edge * ncomp,
+        [=] AMREX_GPU_DEVICE (int idx) noexcept
+        {
+            const int i_edge = idx % n_edge;
+            const int n = idx / n_edge;
+            int i_idx = 0, j_idx = 0;
+            amrex::Real x = 0._rt, y = 0._rt, dxdx = 0._rt;
+            edge(i_edge, i_idx, j_idx, x, y, dxdx);
+            amrex::Real boundary_value = 0._rt;
+            for (int k = 0; k < nc; ++k) {
+                boundary_value += terms[k*n_edge + i_edge] * coeffs[n*nc + k];
             }
-        );
+            // atomic add because the corners of RHS get two values
+            amrex::Gpu::Atomic::AddNoRet(&(arr_rhs(i_idx, j_idx, n)), - boundary_value * factor);
+        });
+}
+
+void
+Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const int lev,
+                              const int which_slice, std::string component,
+                              amrex::MultiFab&& staging_area,
+                              amrex::Real offset, amrex::Real factor)
+{
+    const amrex::Box staging_box = geom[lev].Domain();
+
+    if (lev == 0 && Hipace::m_boundary_field == FieldBoundary::Open) {
+        SetOpenBoundaryCondition<1>(geom[lev], {component}, staging_area, offset, factor);
 
     } else if (lev > 0) {
         HIPACE_PROFILE("Fields::SetMRBoundaryCondition()");
@@ -759,6 +928,26 @@ Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const
     }
 }
 
+void
+Fields::SetBoundaryConditions (amrex::Vector<amrex::Geometry> const& geom, const int lev,
+                               const int which_slice, const std::vector<std::string>& components,
+                               amrex::Real offset, amrex::Real factor)
+{
+    const bool open = lev == 0 && Hipace::m_boundary_field == FieldBoundary::Open;
+    if (open && components.size() == 3) {
+        SetOpenBoundaryCondition<3>(geom[lev], {components[0], components[1], components[2]},
+                                    m_poisson_solver[lev]->StagingArea(), offset, factor);
+    } else if (open && components.size() == 2) {
+        SetOpenBoundaryCondition<2>(geom[lev], {components[0], components[1]},
+                                    m_poisson_solver[lev]->StagingArea(), offset, factor);
+    } else {
+        for (int n = 0; n < static_cast<int>(components.size()); ++n) {
+            SetBoundaryCondition(geom, lev, which_slice, components[n], getStagingArea(lev, n),
+                                 offset, factor);
+        }
+    }
+}
+
 void
 Fields::LevelUpBoundary (amrex::Vector<amrex::Geometry> const& geom, const int lev,
                          const int which_slice, const std::string& component,
@@ -883,38 +1072,53 @@ Fields::SolvePoissonPsiExmByEypBxEzBz (amrex::Vector<amrex::Geometry> const& geo
         amrex::MultiFab lhs_Ez  = getField(lev, WhichSlice::This, "Ez");
         amrex::MultiFab lhs_Bz  = getField(lev, WhichSlice::This, "Bz");
 
+        // if possible, put the three sources into separate components of the staging area
+        // and solve all equations at once
+        const bool batched = m_poisson_solver[lev]->MaxBatchSize() >= 3;
+        const int psi_idx = 0;
+        const int ez_idx = batched ? 1 : 0;
+        const int bz_idx = batched ? 2 : 0;
+
         // Psi: right-hand side 1/episilon0 * -(rho-Jz/c)
-        Multiply(getStagingArea(lev),
+        Multiply(getStagingArea(lev, psi_idx),
             -1._rt/(phys_const.ep0), getField(lev, WhichSlice::This, "rhomjz"));
 
-        SetBoundaryCondition(geom, lev, WhichSlice::This, "Psi", getStagingArea(lev),
-            m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
-
-        m_poisson_solver[lev]->SolvePoissonEquation(lhs_Psi);
+        if (!batched) {
+            SetBoundaryCondition(geom, lev, WhichSlice::This, "Psi", getStagingArea(lev, psi_idx),
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquation(lhs_Psi);
+        }
 
         // Ez: right-hand side 1/(episilon0 *c0 )*(d_x(jx) + d_y(jy))
-        LinCombination(getStagingArea(lev),
+        LinCombination(getStagingArea(lev, ez_idx),
             1._rt/(phys_const.ep0*phys_const.c),
             derivative<Direction::x>{getField(lev, WhichSlice::This, "jx"), geom[lev]},
             1._rt/(phys_const.ep0*phys_const.c),
             derivative<Direction::y>{getField(lev, WhichSlice::This, "jy"), geom[lev]});
 
-        SetBoundaryCondition(geom, lev, WhichSlice::This, "Ez", getStagingArea(lev),
-            m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
-
-        m_poisson_solver[lev]->SolvePoissonEquation(lhs_Ez);
+        if (!batched) {
+            SetBoundaryCondition(geom, lev, WhichSlice::This, "Ez", getStagingArea(lev, ez_idx),
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquation(lhs_Ez);
+        }
 
         // Bz: right-hand side mu_0*(d_y(jx) - d_x(jy))
-        LinCombination(getStagingArea(lev),
+        LinCombination(getStagingArea(lev, bz_idx),
             phys_const.mu0,
             derivative<Direction::y>{getField(lev, WhichSlice::This, "jx"), geom[lev]},
             -phys_const.mu0,
             derivative<Direction::x>{getField(lev, WhichSlice::This, "jy"), geom[lev]});
 
-        SetBoundaryCondition(geom, lev, WhichSlice::This, "Bz", getStagingArea(lev),
-            m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
-
-        m_poisson_solver[lev]->SolvePoissonEquation(lhs_Bz);
+        if (batched) {
+            // the multipole coefficients of all three sources are computed in one pass
+            SetBoundaryConditions(geom, lev, WhichSlice::This, {"Psi", "Ez", "Bz"},
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquations({&lhs_Psi, &lhs_Ez, &lhs_Bz});
+        } else {
+            SetBoundaryCondition(geom, lev, WhichSlice::This, "Bz", getStagingArea(lev, bz_idx),
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquation(lhs_Bz);
+        }
     }
 
     EnforcePeriodic(false, {Comps[WhichSlice::This]["Psi"],
@@ -1005,6 +1209,84 @@ Fields::SolvePoissonEz (amrex::Vector<amrex::Geometry> const& geom,
     }
 }
 
+void
+Fields::SolvePoissonEzSubBox (amrex::Geometry const& geom, const int which_slice,
+                              const amrex::Box& sub_box, const std::string& lhs_component,
+                              const std::string& boundary_component,
+                              const amrex::Real boundary_factor)
+{
+    /* Solves Laplacian(Ez) =  1/(episilon0 *c0 )*(d_x(jx) + d_y(jy)) inside sub_box */
+    HIPACE_PROFILE("Fields::SolvePoissonEzSubBox()");
+
+    constexpr int lev = 0;
+    amrex::MultiFab& slicemf = getSlices(lev);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(slicemf.size() == 1 &&
+        slicemf.boxArray()[0].contains(amrex::grow(sub_box, amrex::IntVect{1, 1, 0})),
+        "The sub-box of SolvePoissonEzSubBox must be inside the slice");
+
+    PhysConst phys_const = get_phys_const();
+
+    if (m_do_symmetrize) {
+        SymmetrizeFields(Comps[which_slice]["jx"], lev, -1, 1);
+        SymmetrizeFields(Comps[which_slice]["jy"], lev, 1, -1);
+    }
+
+    // The FFT plans only depend on the size of the sub-box,
+    // so the solver is defined on a box starting at zero and reused while the size is the same
+    amrex::Box fft_box = sub_box;
+    fft_box -= amrex::IntVect{sub_box.smallEnd(0), sub_box.smallEnd(1), 0};
+    if (!m_sub_box_poisson_solver || m_sub_box_poisson_solver->StagingArea()[0].box() != fft_box) {
+        m_sub_box_poisson_solver = std::make_unique<FFTPoissonSolverDirichletFast>(
+            amrex::BoxArray(fft_box), slicemf.DistributionMap(), geom);
+        m_sub_box_lhs = amrex::MultiFab(amrex::BoxArray(fft_box), slicemf.DistributionMap(), 1, 0);
+    }
+
+    const Array3<amrex::Real> arr = slicemf.array(0);
+    const int jx = Comps[which_slice]["jx"];
+    const int jy = Comps[which_slice]["jy"];
+    const int lhs = Comps[which_slice][lhs_component];
+    const int bnd = Comps[which_slice][boundary_component];
+    const amrex::Real dxih = 0.5_rt*geom.InvCellSize(0);
+    const amrex::Real dyih = 0.5_rt*geom.InvCellSize(1);
+    const amrex::Real fac = 1._rt/(phys_const.ep0*phys_const.c);
+    const int lo0 = sub_box.smallEnd(0);
+    const int lo1 = sub_box.smallEnd(1);
+
+    // Ez: right-hand side 1/(episilon0 *c0 )*(d_x(jx) + d_y(jy)), indexed like the slice
+    amrex::MultiFab& staging_area = m_sub_box_poisson_solver->StagingArea();
+    const Array2<amrex::Real> rhs {{staging_area[0].dataPtr(),
+                                    amrex::begin(sub_box), amrex::end(sub_box), 1}};
+    amrex::ParallelFor(to2D(sub_box),
+        [=] AMREX_GPU_DEVICE (int i, int j) noexcept
+        {
+            rhs(i,j) = fac * ((arr(i+1,j,jx) - arr(i-1,j,jx)) * dxih
+                            + (arr(i,j+1,jy) - arr(i,j-1,jy)) * dyih);
+        });
+
+    // the boundary values are read directly from the cells around sub_box
+    const amrex::Real poff_x = GetPosOffset(0, geom, sub_box);
+    const amrex::Real poff_y = GetPosOffset(1, geom, sub_box);
+    const amrex::Real dx_inv = geom.InvCellSize(0);
+    const amrex::Real dy_inv = geom.InvCellSize(1);
+    SetDirichletBoundaries(rhs, sub_box, geom, m_sub_box_poisson_solver->BoundaryOffset(),
+        m_sub_box_poisson_solver->BoundaryFactor(),
+        [=] AMREX_GPU_DEVICE (amrex::Real x, amrex::Real y) noexcept -> amrex::Real
+        {
+            const int i = static_cast<int>(amrex::Math::floor((x - poff_x) * dx_inv + 0.5_rt));
+            const int j = static_cast<int>(amrex::Math::floor((y - poff_y) * dy_inv + 0.5_rt));
+            return boundary_factor * arr(i,j,bnd);
+        });
+
+    m_sub_box_poisson_solver->SolvePoissonEquation(m_sub_box_lhs);
+
+    const Array2<amrex::Real> sol = m_sub_box_lhs.array(0);
+    amrex::ParallelFor(to2D(sub_box),
+        [=] AMREX_GPU_DEVICE (int i, int j) noexcept
+        {
+            arr(i,j,lhs) = sol(i-lo0, j-lo1);
+        });
+}
+
 void
 Fields::SolvePoissonBxBy (amrex::Vector<amrex::Geometry> const& geom,
                           const int current_N_level, const int which_slice)
@@ -1041,31 +1323,43 @@ Fields::SolvePoissonBxBy (amrex::Vector<amrex::Geometry> const& geom,
         amrex::MultiFab lhs_Bx = getField(lev, which_slice, "Bx");
         amrex::MultiFab lhs_By = getField(lev, which_slice, "By");
 
+        // if possible, solve Bx and By at once
+        const bool batched = m_poisson_solver[lev]->MaxBatchSize() >= 2;
+        const int bx_idx = 0;
+        const int by_idx = batched ? 1 : 0;
+
         // Bx: right-hand side mu_0*(- d_y(jz) + d_z(jy) )
-        LinCombination(getStagingArea(lev),
+        LinCombination(getStagingArea(lev, bx_idx),
                     -phys_const.mu0,
                     derivative<Direction::y>{getField(lev, WhichSlice::This, "jz"), geom[lev]},
                     phys_const.mu0,
                     derivative<Direction::z>{getField(lev, WhichSlice::Previous, "jy"),
                     getField(lev, WhichSlice::Next, "jy"), geom[lev]});
 
-        SetBoundaryCondition(geom, lev, which_slice, "Bx", getStagingArea(lev),
-            m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
-
-        m_poisson_solver[lev]->SolvePoissonEquation(lhs_Bx);
+        if (!batched) {
+            SetBoundaryCondition(geom, lev, which_slice, "Bx", getStagingArea(lev, bx_idx),
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquation(lhs_Bx);
+        }
 
         // By: right-hand side mu_0*(d_x(jz) - d_z(jx) )
-        LinCombination(getStagingArea(lev),
+        LinCombination(getStagingArea(lev, by_idx),
                    phys_const.mu0,
                    derivative<Direction::x>{getField(lev, WhichSlice::This, "jz"), geom[lev]},
                    -phys_const.mu0,
                    derivative<Direction::z>{getField(lev, WhichSlice::Previous, "jx"),
                    getField(lev, WhichSlice::Next, "jx"), geom[lev]});
 
-        SetBoundaryCondition(geom, lev, which_slice, "By", getStagingArea(lev),
-            m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
-
-        m_poisson_solver[lev]->SolvePoissonEquation(lhs_By);
+        if (batched) {
+            // the multipole coefficients of both sources are computed in one pass
+            SetBoundaryConditions(geom, lev, which_slice, {"Bx", "By"},
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquations({&lhs_Bx, &lhs_By});
+        } else {
+            SetBoundaryCondition(geom, lev, which_slice, "By", getStagingArea(lev, by_idx),
+                m_poisson_solver[lev]->BoundaryOffset(), m_poisson_solver[lev]->BoundaryFactor());
+            m_poisson_solver[lev]->SolvePoissonEquation(lhs_By);
+        }
     }
 
     EnforcePeriodic(false, {Comps[which_slice]["Bx"],
@@ -1225,6 +1519,118 @@ Fields::MixAndShiftBfields (const amrex::Real relative_Bfield_error,
     duplicate(lev, WhichSlice::PCPrevIter, {"Bx", "By"}, WhichSlice::PCIter, {"Bx", "By"});
 }
 
+void
+Fields::AndersonMixBfields (const amrex::Vector<amrex::Geometry>& geom,
+                            const int current_N_level,
+                            const amrex::Real predcorr_B_mixing_factor)
+{
+    HIPACE_PROFILE("Fields::AndersonMixBfields()");
+
+    const int depth = Hipace::m_predcorr_anderson_depth;
+    AMREX_ALWAYS_ASSERT(depth > 0 && static_cast<int>(m_anderson_history.size()) >= current_N_level);
+    AMREX_ALWAYS_ASSERT(Comps[WhichSlice::This]["Bx"]+1==Comps[WhichSlice::This]["By"]);
+    AMREX_ALWAYS_ASSERT(Comps[WhichSlice::PCIter]["Bx"]+1==Comps[WhichSlice::PCIter]["By"]);
+
+    const int B = Comps[WhichSlice::This]["Bx"];
+    const int B_iter = Comps[WhichSlice::PCIter]["Bx"];
+    // components of m_anderson_history, every entry holds Bx and By
+    const int x_prev = 0;
+    const int f_prev = 2;
+    const int f_cur = 4;
+    const auto dx = [] (int j) { return 6 + 4*j; };
+    const auto df = [] (int j) { return 8 + 4*j; };
+    // the differences are stored in a ring buffer, the newest one is at this index
+    const int newest = m_anderson_num_iter > 0 ? (m_anderson_num_iter - 1) % depth : 0;
+
+    for (int lev=0; lev<current_N_level; ++lev) {
+        amrex::MultiFab& slicemf = getSlices(lev);
+        amrex::MultiFab& hist = m_anderson_history[lev];
+
+        // f = B[PCIter] - B
+        amrex::MultiFab::LinComb(hist, 1._rt, slicemf, B_iter, -1._rt, slicemf, B,
+                                 f_cur, 2, m_slices_nguards);
+        if (m_anderson_num_iter > 0) {
+            amrex::MultiFab::LinComb(hist, 1._rt, slicemf, B, -1._rt, hist, x_prev,
+                                     dx(newest), 2, m_slices_nguards);
+            amrex::MultiFab::LinComb(hist, 1._rt, hist, f_cur, -1._rt, hist, f_prev,
+                                     df(newest), 2, m_slices_nguards);
+        }
+        amrex::MultiFab::Copy(hist, slicemf, B, x_prev, 2, m_slices_nguards);
+        amrex::MultiFab::Copy(hist, hist, f_cur, f_prev, 2, m_slices_nguards);
+    }
+    if (m_anderson_num_iter > 0) m_anderson_num_hist = std::min(m_anderson_num_hist + 1, depth);
+    ++m_anderson_num_iter;
+
+    // scalar product over all levels, with a factor to account for different cell size with MR
+    const auto dot = [&] (int comp1, int comp2) {
+        amrex::Real sum = 0._rt;
+        for (int lev=0; lev<current_N_level; ++lev) {
+            const amrex::Real factor = geom[lev].CellSize(0) * geom[lev].CellSize(1) /
+                (geom[0].CellSize(0) * geom[0].CellSize(1));
+            sum += factor * amrex::MultiFab::Dot(m_anderson_history[lev], comp1,
+                                                 m_anderson_history[lev], comp2, 2, 0, true);
+        }
+        return sum;
+    };
+
+    // solve the normal equations of the least squares problem min |f - sum_j g_j*df_j|
+    // with Gaussian elimination, regularized to handle nearly collinear differences
+    const int n = m_anderson_num_hist;
+    amrex::Vector<amrex::Real> mat(n*n);
+    amrex::Vector<amrex::Real> gamma(n);
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<=i; ++j) {
+            mat[i*n+j] = mat[j*n+i] = dot(df(i), df(j));
+        }
+        gamma[i] = dot(df(i), f_cur);
+    }
+    for (int i=0; i<n; ++i) mat[i*n+i] *= 1._rt + 1.e-10_rt;
+
+    bool singular = false;
+    for (int k=0; k<n && !singular; ++k) {
+        int pivot = k;
+        for (int i=k+1; i<n; ++i) {
+            if (std::abs(mat[i*n+k]) > std::abs(mat[pivot*n+k])) pivot = i;
+        }
+        if (!(std::abs(mat[pivot*n+k]) > 0._rt)) {
+            singular = true;
+            break;
+        }
+        for (int j=0; j<n; ++j) std::swap(mat[k*n+j], mat[pivot*n+j]);
+        std::swap(gamma[k], gamma[pivot]);
+        for (int i=k+1; i<n; ++i) {
+            const amrex::Real l = mat[i*n+k] / mat[k*n+k];
+            for (int j=k; j<n; ++j) mat[i*n+j] -= l * mat[k*n+j];
+            gamma[i] -= l * gamma[k];
+        }
+    }
+    for (int k=n-1; k>=0 && !singular; --k) {
+        for (int j=k+1; j<n; ++j) gamma[k] -= mat[k*n+j] * gamma[j];
+        gamma[k] /= mat[k*n+k];
+    }
+    if (singular) {
+        // fall back to simple mixing for this iteration
+        for (auto& g : gamma) g = 0._rt;
+    }
+
+    for (int lev=0; lev<current_N_level; ++lev) {
+        amrex::MultiFab& slicemf = getSlices(lev);
+        amrex::MultiFab& hist = m_anderson_history[lev];
+
+        /* B = B + a*f - sum_j g_j*(dx_j + a*df_j) */
+        amrex::MultiFab::Saxpy(slicemf, predcorr_B_mixing_factor, hist, f_cur, B, 2,
+                               m_slices_nguards);
+        for (int j=0; j<n; ++j) {
+            amrex::MultiFab::Saxpy(slicemf, -gamma[j], hist, dx(j), B, 2, m_slices_nguards);
+            amrex::MultiFab::Saxpy(slicemf, -gamma[j]*predcorr_B_mixing_factor, hist, df(j), B, 2,
+                                   m_slices_nguards);
+        }
+
+        /* Shifting the B field from the current iteration to the previous iteration */
+        duplicate(lev, WhichSlice::PCPrevIter, {"Bx", "By"}, WhichSlice::PCIter, {"Bx", "By"});
+    }
+}
+
 amrex::Real
 Fields::ComputeRelBFieldError (const int which_slice, const int which_slice_iter,
                                const amrex::Vector<amrex::Geometry>& geom,
@@ -1286,7 +1692,7 @@ Fields::ComputeRelBFieldError (const int which_slice, const int which_slice_iter
 }
 
 void
-Fields::InSituComputeDiags (int step, amrex::Real time, int islice, const amrex::Geometry& geom3D,
+Fields::InSituComputeDiags (int step, amrex::Real time, int islice,
                             int max_step, amrex::Real max_time)
 {
     if (!utils::doDiagnostics(m_insitu_period, step, max_step, time, max_time)) return;
@@ -1296,11 +1702,9 @@ Fields::InSituComputeDiags (int step, amrex::Real time, int islice, const amrex:
 
     constexpr int lev = 0;
 
-    AMREX_ALWAYS_ASSERT(m_insitu_rdata.size()>0 && m_insitu_sum_rdata.size()>0 );
+    AMREX_ALWAYS_ASSERT(!m_insitu_acc.empty());
 
     const amrex::Real clight = get_phys_const().c;
-    const amrex::Real dxdydz = geom3D.CellSize(0) * geom3D.CellSize(1) * geom3D.CellSize(2);
-    const int nslices = geom3D.Domain().length(2);
     const int ExmBy = Comps[WhichSlice::This]["ExmBy"];
     const int EypBx = Comps[WhichSlice::This]["EypBx"];
     const int Ez = Comps[WhichSlice::This]["Ez"];
@@ -1313,17 +1717,13 @@ Fields::InSituComputeDiags (int step, amrex::Real time, int islice, const amrex:
 
     amrex::MultiFab& slicemf = getSlices(lev);
 
-    amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpSum[m_insitu_nrp]> reduce_op;
-    amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[m_insitu_nrp]> reduce_data(reduce_op);
-    using ReduceTuple = typename decltype(reduce_data)::Type;
-
+    // the results stay on the device until InSituWriteToFile, so there is no synchronization here
     for ( amrex::MFIter mfi(slicemf, DfltMfi); mfi.isValid(); ++mfi ) {
         Array3<amrex::Real const> const arr = slicemf.const_array(mfi);
-        reduce_op.eval(
-            mfi.tilebox(), reduce_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int) -> ReduceTuple
+        m_insitu_acc.Reduce(islice, mfi.tilebox(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int) -> amrex::GpuArray<amrex::Real, m_insitu_nrp>
             {
-                return {                                            // Tuple contains:
+                return {                                            // Array contains:
                     pow<2>(arr(i,j,ExmBy) + arr(i,j,By) * clight),  // 0    [Ex^2]
                     pow<2>(arr(i,j,EypBx) - arr(i,j,Bx) * clight),  // 1    [Ey^2]
                     pow<2>(arr(i,j,Ez)),                            // 2    [Ez^2]
@@ -1337,13 +1737,6 @@ Fields::InSituComputeDiags (int step, amrex::Real time, int islice, const amrex:
                 };
             });
     }
-
-    auto real_arr = amrex::tupleToArray(reduce_data.value());
-
-    for (int i=0; i<m_insitu_nrp; ++i) {
-        m_insitu_rdata[islice + i * nslices] = real_arr[i] * dxdydz;
-        m_insitu_sum_rdata[i] += real_arr[i] * dxdydz;
-    }
 }
 
 void
@@ -1370,6 +1763,17 @@ Fields::InSituWriteToFile (int step, amrex::Real time, const amrex::Geometry& ge
     const int nslices_int = geom3D.Domain().length(2);
     const std::size_t nslices = static_cast<std::size_t>(nslices_int);
     const int is_normalized_units = Hipace::m_normalized_units;
+    const amrex::Real dxdydz = geom3D.CellSize(0) * geom3D.CellSize(1) * geom3D.CellSize(2);
+
+    // get the data of all slices from the device
+    m_insitu_acc.CopyToHost();
+    for (int i=0; i<m_insitu_nrp; ++i) {
+        for (int islice=0; islice<nslices_int; ++islice) {
+            m_insitu_rdata[islice + i * nslices] = static_cast<amrex::Real>(
+                m_insitu_acc.get(islice, i) * dxdydz);
+            m_insitu_sum_rdata[i] += m_insitu_rdata[islice + i * nslices];
+        }
+    }
 
     // specify the structure of the data later available in python
     // avoid pointers to temporary objects as second argument, stack variables are ok
@@ -16,8 +16,12 @@
 FFTPoissonSolverDirichletFast::FFTPoissonSolverDirichletFast (
     amrex::BoxArray const& realspace_ba,
     amrex::DistributionMapping const& dm,
-    amrex::Geometry const& gm )
+    amrex::Geometry const& gm,
+    const int max_batch_size )
 {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(max_batch_size >= 1,
+        "FFTPoissonSolverDirichletFast needs a batch size of at least 1");
+    m_max_batch_size = max_batch_size;
     define(realspace_ba, dm, gm);
 }
 
@@ -92,14 +96,18 @@ void ToSine (const Array2<amrex::Real> in, const Array2<amrex::Real> out,
         });
 }
 
+/** \brief ToSine, transpose and ToComplex for n_comps stacked arrays.
+ * Array n of the input starts at row n*n_batch, array n of the output starts at row n*n_data.
+ */
 void ToSine_Transpose_ToComplex (const Array2<amrex::Real> in,
                                  const Array2<amrex::GpuComplex<amrex::Real>> out,
-                                 const amrex::Real* sine_factor, const int n_data, const int n_batch)
+                                 const amrex::Real* sine_factor, const int n_data, const int n_batch,
+                                 const int n_comps)
 {
     const int n_half = (n_batch+1)/2;
 
-    auto transpose_to_sine = [=] AMREX_GPU_DEVICE (int i, int j) {
-        return to_sine(in, j, i, n_data, sine_factor);
+    auto transpose_to_sine = [=] AMREX_GPU_DEVICE (int i, int j, int n) {
+        return to_sine(in, j, i + n*n_batch, n_data, sine_factor);
     };
 
 #if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
@@ -117,14 +125,17 @@ void ToSine_Transpose_ToComplex (const Array2<amrex::Real> in,
 
     const int num_blocks_x = (nx + tile_dim_x - 1)/tile_dim_x;
     const int num_blocks_y = (ny + tile_dim_y - 1)/tile_dim_y;
+    const int num_blocks_comp = num_blocks_x*num_blocks_y;
 
-    amrex::launch<tile_dim_x*block_rows_y>(num_blocks_x*num_blocks_y, amrex::Gpu::gpuStream(),
+    amrex::launch<tile_dim_x*block_rows_y>(num_blocks_comp*n_comps, amrex::Gpu::gpuStream(),
         [=] AMREX_GPU_DEVICE() noexcept
         {
             __shared__ amrex::Real tile_ptr[tile_dim_x_ex * tile_dim_y];
 
-            const int block_y = blockIdx.x / num_blocks_x;
-            const int block_x = blockIdx.x - block_y*num_blocks_x;
+            const int n = blockIdx.x / num_blocks_comp;
+            const int block_xy = blockIdx.x - n*num_blocks_comp;
+            const int block_y = block_xy / num_blocks_x;
+            const int block_x = block_xy - block_y*num_blocks_x;
 
             const int tile_begin_x = 2 * block_x * tile_dim_x - 2;
             const int tile_begin_y = block_y * tile_dim_y;
@@ -144,7 +155,7 @@ void ToSine_Transpose_ToComplex (const Array2<amrex::Real> in,
                     const int j = tile_begin_y + thread_y;
 
                     if (j < nx_sin && i < ny_sin && i >= 0 ) {
-                        shared(i, j) = transpose_to_sine(i, j);
+                        shared(i, j) = transpose_to_sine(i, j, n);
                     }
                 }
             }
@@ -160,35 +171,41 @@ void ToSine_Transpose_ToComplex (const Array2<amrex::Real> in,
                     const int j = tile_begin_y + ty;
 
                     if (i < nx && j < ny) {
-                        out(i, j) = to_complex(shared, i, j, n_half, n_batch);
+                        out(i, j + n*n_data) = to_complex(shared, i, j, n_half, n_batch);
                     }
                 }
             }
         });
 #else
-    amrex::ParallelFor(amrex::BoxND<2>{{0,0}, {n_half,n_data-1}},
-        [=] AMREX_GPU_DEVICE(int i, int j) noexcept
+    amrex::ParallelFor(amrex::Box{{0,0,0}, {n_half,n_data-1,n_comps-1}},
+        [=] AMREX_GPU_DEVICE(int i, int j, int n) noexcept
         {
-            out(i, j) = to_complex(transpose_to_sine, i, j, n_half, n_batch);
+            auto transpose_to_sine_n = [=] (int ii, int jj) {
+                return transpose_to_sine(ii, jj, n);
+            };
+            out(i, j + n*n_data) = to_complex(transpose_to_sine_n, i, j, n_half, n_batch);
         });
 #endif
 }
 
+/** \brief ToSine, multiplication with the eigenvalues and ToComplex for n_comps stacked arrays.
+ * Array n of both the input and the output starts at row n*n_batch.
+ */
 void ToSine_Mult_ToComplex (const Array2<amrex::Real> in,
                             const Array2<amrex::GpuComplex<amrex::Real>> out,
                             const Array2<amrex::Real> eigenvalue,
-                            const amrex::Real* sine_factor, const int n_data, const int n_batch)
+                            const amrex::Real* sine_factor, const int n_data, const int n_batch,
+                            const int n_comps)
 {
     const int n_half = (n_data+1)/2;
 
-    auto mult_to_sine = [=] AMREX_GPU_DEVICE (int i, int j) {
-        return eigenvalue(i, j) * to_sine(in, i, j, n_data, sine_factor);
-    };
-
-    amrex::ParallelFor(amrex::BoxND<2>{{0,0}, {n_half,n_batch-1}},
-        [=] AMREX_GPU_DEVICE(int i, int j) noexcept
+    amrex::ParallelFor(amrex::Box{{0,0,0}, {n_half,n_batch-1,n_comps-1}},
+        [=] AMREX_GPU_DEVICE(int i, int j, int n) noexcept
         {
-            out(i, j) = to_complex(mult_to_sine, i, j, n_half, n_data);
+            auto mult_to_sine = [=] (int ii, int jj) {
+                return eigenvalue(ii, jj) * to_sine(in, ii, jj + n*n_batch, n_data, sine_factor);
+            };
+            out(i, j + n*n_batch) = to_complex(mult_to_sine, i, j, n_half, n_data);
         });
 }
 
@@ -207,7 +224,9 @@ FFTPoissonSolverDirichletFast::define (amrex::BoxArray const& a_realspace_ba,
     // These arrays will store the data just before/after the FFT
     // The stagingArea is also created from 0 to nx, because the real space array may have
     // an offset for levels > 0
-    m_stagingArea = amrex::MultiFab(a_realspace_ba, dm, 1, 0);
+    // For batched solves, the source terms are stored in separate components of the staging area.
+    // These are contiguous in memory, so that all of them can be transformed as one long batch.
+    m_stagingArea = amrex::MultiFab(a_realspace_ba, dm, m_max_batch_size, 0);
     m_stagingArea.setVal(0.0); // this is not required
 
     // This must be true even for parallel FFT.
@@ -219,51 +238,39 @@ FFTPoissonSolverDirichletFast::define (amrex::BoxArray const& a_realspace_ba,
     const int nx = fft_size[0];
     const int ny = fft_size[1];
     const auto dx = gm.CellSizeArray();
-    const amrex::Real dxsquared = dx[0]*dx[0];
-    const amrex::Real dysquared = dx[1]*dx[1];
-    const amrex::Real sine_x_factor = MathConst::pi / ( 2. * ( nx + 1 ));
-    const amrex::Real sine_y_factor = MathConst::pi / ( 2. * ( ny + 1 ));
-
-    // Normalization of FFTW's 'DST-I' discrete sine transform (FFTW_RODFT00)
-    // This normalization is used regardless of the sine transform library
-    const amrex::Real norm_fac = 0.5 / ( 2 * (( nx + 1 ) * ( ny + 1 )));
+    m_dx = dx[0];
+    m_dy = dx[1];
 
     // Calculate the array of m_eigenvalue_matrix
     m_eigenvalue_matrix.resize({{0,0,0}, {ny-1,nx-1,0}});
-    Array2<amrex::Real> eigenvalue_matrix = m_eigenvalue_matrix.array();
-    amrex::ParallelFor(amrex::BoxND<2>{{0,0}, {ny-1,nx-1}},
-        [=] AMREX_GPU_DEVICE (int j, int i) noexcept
-        {
-            /* fast poisson solver diagonal x coeffs */
-            amrex::Real sinex_sq = std::sin(( i + 1 ) * sine_x_factor) * std::sin(( i + 1 ) * sine_x_factor);
-            /* fast poisson solver diagonal y coeffs */
-            amrex::Real siney_sq = std::sin(( j + 1 ) * sine_y_factor) * std::sin(( j + 1 ) * sine_y_factor);
+    m_screening = -1.;
+    SetScreening(0.);
 
-            if ((sinex_sq!=0) && (siney_sq!=0)) {
-                eigenvalue_matrix(j,i) = norm_fac / ( -4.0_rt * ( sinex_sq / dxsquared + siney_sq / dysquared ));
-            } else {
-                // Avoid division by 0
-                eigenvalue_matrix(j,i) = 0._rt;
-            }
-        });
-
-    // Allocate 1d Array for 2d data or 2d transpose data
+    // Allocate 1d Array for 2d data or 2d transpose data, for every equation in a batch
     const int real_1d_size = std::max((nx+1)*ny, (ny+1)*nx);
     const int complex_1d_size = std::max(((nx+1)/2+1)*ny, ((ny+1)/2+1)*nx);
-    m_position_array.resize(real_1d_size);
-    m_fourier_array.resize(complex_1d_size);
-
-    // Allocate and initialize the FFT plans
-    std::size_t fft_x_area = m_x_fft.Initialize(FFTType::C2R_1D_batched, nx+1, ny);
-    std::size_t fft_y_area = m_y_fft.Initialize(FFTType::C2R_1D_batched, ny+1, nx);
+    m_position_array.resize(real_1d_size * m_max_batch_size);
+    m_fourier_array.resize(complex_1d_size * m_max_batch_size);
+
+    // Allocate and initialize the FFT plans, one pair for every possible batch size.
+    // A batch of b equations is executed as a single 1D FFT with b times the number of rows.
+    std::size_t fft_area = 0;
+    for (int b=1; b<=m_max_batch_size; ++b) {
+        m_x_fft.emplace_back(std::make_unique<AnyFFT>());
+        m_y_fft.emplace_back(std::make_unique<AnyFFT>());
+        fft_area = std::max(fft_area, m_x_fft.back()->Initialize(FFTType::C2R_1D_batched, nx+1, ny*b));
+        fft_area = std::max(fft_area, m_y_fft.back()->Initialize(FFTType::C2R_1D_batched, ny+1, nx*b));
+    }
 
-    // Allocate work area for both FFTs
-    m_fft_work_area.resize(std::max(fft_x_area, fft_y_area));
+    // Allocate work area for all FFTs
+    m_fft_work_area.resize(fft_area);
 
-    m_x_fft.SetBuffers(m_fourier_array.dataPtr(), m_position_array.dataPtr(),
-                       m_fft_work_area.dataPtr());
-    m_y_fft.SetBuffers(m_fourier_array.dataPtr(), m_position_array.dataPtr(),
-                       m_fft_work_area.dataPtr());
+    for (int b=0; b<m_max_batch_size; ++b) {
+        m_x_fft[b]->SetBuffers(m_fourier_array.dataPtr(), m_position_array.dataPtr(),
+                               m_fft_work_area.dataPtr());
+        m_y_fft[b]->SetBuffers(m_fourier_array.dataPtr(), m_position_array.dataPtr(),
+                               m_fft_work_area.dataPtr());
+    }
 
     // set up prefactors for ToSine
     m_sine_x_factor.resize(nx);
@@ -282,47 +289,107 @@ FFTPoissonSolverDirichletFast::define (amrex::BoxArray const& a_realspace_ba,
 }
 
 
+void
+FFTPoissonSolverDirichletFast::SetScreening (const amrex::Real screening)
+{
+    if (screening == m_screening) return;
+    HIPACE_PROFILE("FFTPoissonSolverDirichletFast::SetScreening()");
+    using namespace amrex::literals;
+
+    m_screening = screening;
+
+    const int nx = m_stagingArea[0].box().length(0);
+    const int ny = m_stagingArea[0].box().length(1);
+    const amrex::Real dxsquared = m_dx*m_dx;
+    const amrex::Real dysquared = m_dy*m_dy;
+    const amrex::Real sine_x_factor = MathConst::pi / ( 2. * ( nx + 1 ));
+    const amrex::Real sine_y_factor = MathConst::pi / ( 2. * ( ny + 1 ));
+
+    // Normalization of FFTW's 'DST-I' discrete sine transform (FFTW_RODFT00)
+    // This normalization is used regardless of the sine transform library
+    const amrex::Real norm_fac = 0.5 / ( 2 * (( nx + 1 ) * ( ny + 1 )));
+
+    Array2<amrex::Real> eigenvalue_matrix = m_eigenvalue_matrix.array();
+    amrex::ParallelFor(amrex::BoxND<2>{{0,0}, {ny-1,nx-1}},
+        [=] AMREX_GPU_DEVICE (int j, int i) noexcept
+        {
+            /* fast poisson solver diagonal x coeffs */
+            amrex::Real sinex_sq = std::sin(( i + 1 ) * sine_x_factor) * std::sin(( i + 1 ) * sine_x_factor);
+            /* fast poisson solver diagonal y coeffs */
+            amrex::Real siney_sq = std::sin(( j + 1 ) * sine_y_factor) * std::sin(( j + 1 ) * sine_y_factor);
+
+            if ((sinex_sq!=0) && (siney_sq!=0)) {
+                eigenvalue_matrix(j,i) = norm_fac / ( -4.0_rt * ( sinex_sq / dxsquared + siney_sq / dysquared )
+                                                      - screening );
+            } else {
+                // Avoid division by 0
+                eigenvalue_matrix(j,i) = 0._rt;
+            }
+        });
+}
+
 void
 FFTPoissonSolverDirichletFast::SolvePoissonEquation (amrex::MultiFab& lhs_mf)
+{
+    SolvePoissonEquations({&lhs_mf});
+}
+
+
+void
+FFTPoissonSolverDirichletFast::SolvePoissonEquations (const amrex::Vector<amrex::MultiFab*>& lhs_mfs)
 {
     HIPACE_PROFILE("FFTPoissonSolverDirichletFast::SolvePoissonEquation()");
 
+    const int n_comps = lhs_mfs.size();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_comps >= 1 && n_comps <= m_max_batch_size,
+        "Number of equations exceeds the batch size of FFTPoissonSolverDirichletFast");
+
     const int nx = m_stagingArea[0].box().length(0); // initially contiguous
     const int ny = m_stagingArea[0].box().length(1); // contiguous after transpose
 
-    Array2<amrex::Real> pos_arr {{m_stagingArea[0].dataPtr(), {0,0,0}, {nx,ny,1}, 1}};
+    // the components of the staging area are stacked in y
+    Array2<amrex::Real> pos_arr {{m_stagingArea[0].dataPtr(), {0,0,0}, {nx,ny*n_comps,1}, 1}};
+
+    Array2<amrex::Real> real_arr {{m_position_array.dataPtr(), {0,0,0}, {nx+1,ny*n_comps,1}, 1}};
+    Array2<amrex::Real> real_arr_t {{m_position_array.dataPtr(), {0,0,0}, {ny+1,nx*n_comps,1}, 1}};
 
-    Array2<amrex::Real> real_arr {{m_position_array.dataPtr(), {0,0,0}, {nx+1,ny,1}, 1}};
-    Array2<amrex::Real> real_arr_t {{m_position_array.dataPtr(), {0,0,0}, {ny+1,nx,1}, 1}};
+    Array2<amrex::GpuComplex<amrex::Real>> comp_arr {{ m_fourier_array.dataPtr(), {0,0,0}, {(nx+1)/2+1,ny*n_comps,1}, 1}};
+    Array2<amrex::GpuComplex<amrex::Real>> comp_arr_t {{ m_fourier_array.dataPtr(), {0,0,0}, {(ny+1)/2+1,nx*n_comps,1}, 1}};
 
-    Array2<amrex::GpuComplex<amrex::Real>> comp_arr {{ m_fourier_array.dataPtr(), {0,0,0}, {(nx+1)/2+1,ny,1}, 1}};
-    Array2<amrex::GpuComplex<amrex::Real>> comp_arr_t {{ m_fourier_array.dataPtr(), {0,0,0}, {(ny+1)/2+1,nx,1}, 1}};
+    AnyFFT& x_fft = *m_x_fft[n_comps-1];
+    AnyFFT& y_fft = *m_y_fft[n_comps-1];
 
     // 1D DST in x
-    ToComplex(pos_arr, comp_arr, nx, ny);
+    ToComplex(pos_arr, comp_arr, nx, ny*n_comps);
 
-    m_x_fft.Execute();
+    x_fft.Execute();
 
     // 1D DST in y
-    ToSine_Transpose_ToComplex(real_arr, comp_arr_t, m_sine_x_factor.dataPtr(), nx, ny);
+    ToSine_Transpose_ToComplex(real_arr, comp_arr_t, m_sine_x_factor.dataPtr(), nx, ny, n_comps);
 
-    m_y_fft.Execute();
+    y_fft.Execute();
 
     // 1D DST in y
     ToSine_Mult_ToComplex(real_arr_t, comp_arr_t, m_eigenvalue_matrix.array(),
-                          m_sine_y_factor.dataPtr(), ny, nx);
+                          m_sine_y_factor.dataPtr(), ny, nx, n_comps);
 
-    m_y_fft.Execute();
+    y_fft.Execute();
 
     // 1D DST in x
-    ToSine_Transpose_ToComplex(real_arr_t, comp_arr, m_sine_y_factor.dataPtr(), ny, nx);
+    ToSine_Transpose_ToComplex(real_arr_t, comp_arr, m_sine_y_factor.dataPtr(), ny, nx, n_comps);
 
-    m_x_fft.Execute();
+    x_fft.Execute();
 
-    amrex::Box lhs_bx = lhs_mf[0].box();
-    // shift box to handle ghost cells properly
-    lhs_bx -= m_stagingArea[0].box().smallEnd();
-    Array2<amrex::Real> lhs_arr {{lhs_mf[0].dataPtr(), amrex::begin(lhs_bx), amrex::end(lhs_bx), 1}};
+    for (int n=0; n<n_comps; ++n) {
+        amrex::MultiFab& lhs_mf = *lhs_mfs[n];
+        amrex::Box lhs_bx = lhs_mf[0].box();
+        // shift box to handle ghost cells properly
+        lhs_bx -= m_stagingArea[0].box().smallEnd();
+        Array2<amrex::Real> lhs_arr {{lhs_mf[0].dataPtr(), amrex::begin(lhs_bx), amrex::end(lhs_bx), 1}};
 
-    ToSine(real_arr, lhs_arr, m_sine_x_factor.dataPtr(), nx, ny);
+        Array2<amrex::Real> real_arr_n {{m_position_array.dataPtr() + n*(nx+1)*ny,
+                                         {0,0,0}, {nx+1,ny,1}, 1}};
+
+        ToSine(real_arr_n, lhs_arr, m_sine_x_factor.dataPtr(), nx, ny);
+    }
 }
@@ -245,6 +245,6 @@ AnyFFT::~AnyFFT () {
     }
 }
 
-void AnyFFT::setup () {}
+void AnyFFT::setup (const std::string&) {}
 
 void AnyFFT::cleanup () {}
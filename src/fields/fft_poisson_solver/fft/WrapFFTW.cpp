@@ -14,6 +14,9 @@
 #include "AnyFFT.H"
 
 #include <AMReX_Config.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Vector.H>
 
 #ifdef AMREX_USE_OMP
 #include <omp.h>
@@ -21,12 +24,19 @@
 
 #include <fftw3.h>
 
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
 #ifdef AMREX_USE_FLOAT
 static constexpr bool use_float = true;
 #else
 static constexpr bool use_float = false;
 #endif
 
+/** File with the FFTW wisdom, written by the IO processor in cleanup if not empty */
+static std::string s_wisdom_file = "";
+
 struct VendorPlan {
     fftwf_plan m_fftwf_plan;
     fftw_plan m_fftw_plan;
@@ -156,7 +166,7 @@ AnyFFT::~AnyFFT () {
     }
 }
 
-void AnyFFT::setup () {
+void AnyFFT::setup (const std::string& wisdom_file) {
 #if defined(AMREX_USE_OMP) && defined(HIPACE_FFTW_OMP)
     if constexpr (use_float) {
         fftwf_init_threads();
@@ -166,9 +176,45 @@ void AnyFFT::setup () {
         fftw_plan_with_nthreads(omp_get_max_threads());
     }
 #endif
+    s_wisdom_file = wisdom_file;
+    if (!s_wisdom_file.empty()) {
+        // one rank reads the file and broadcasts it, the file may not exist yet
+        amrex::Vector<char> wisdom;
+        amrex::ParallelDescriptor::ReadAndBcastFile(s_wisdom_file, wisdom, false);
+        if (!wisdom.empty()) {
+            // FFTW_MEASURE planning is almost free for all sizes contained in the wisdom
+            int success = 0;
+            if constexpr (use_float) {
+                success = fftwf_import_wisdom_from_string(wisdom.data());
+            } else {
+                success = fftw_import_wisdom_from_string(wisdom.data());
+            }
+            if (!success) {
+                amrex::Print() << "WARNING: could not import the FFTW wisdom from "
+                               << s_wisdom_file << ", all FFT sizes are measured again\n";
+            }
+        }
+    }
 }
 
 void AnyFFT::cleanup () {
+    if (!s_wisdom_file.empty() && amrex::ParallelDescriptor::IOProcessor()) {
+        // contains the imported wisdom plus the plans measured during this run.
+        // Other simulations may read or write the same file at the same time, so the wisdom is
+        // written to a file unique to this process, which then atomically replaces the old file.
+        const std::string tmp_file = s_wisdom_file + ".tmp" + std::to_string(getpid());
+        int success = 0;
+        if constexpr (use_float) {
+            success = fftwf_export_wisdom_to_filename(tmp_file.c_str());
+        } else {
+            success = fftw_export_wisdom_to_filename(tmp_file.c_str());
+        }
+        if (!success || std::rename(tmp_file.c_str(), s_wisdom_file.c_str()) != 0) {
+            std::remove(tmp_file.c_str());
+            amrex::Print() << "WARNING: could not write the FFTW wisdom to "
+                           << s_wisdom_file << "\n";
+        }
+    }
 #if defined(AMREX_USE_OMP) && defined(HIPACE_FFTW_OMP)
     if constexpr (use_float) {
         fftwf_cleanup_threads();
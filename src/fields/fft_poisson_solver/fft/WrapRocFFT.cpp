@@ -180,7 +180,7 @@ AnyFFT::~AnyFFT () {
     }
 }
 
-void AnyFFT::setup () {
+void AnyFFT::setup (const std::string&) {
     rocfft_status status;
 
     status = rocfft_setup();
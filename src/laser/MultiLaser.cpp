@@ -23,6 +23,9 @@
 #endif
 #include <AMReX_GpuComplex.H>
 
+#include <algorithm>
+#include <limits>
+
 void
 MultiLaser::ReadParameters ()
 {
@@ -47,6 +50,9 @@ MultiLaser::ReadParameters ()
     bool mg_param_given = queryWithParser(pp, "MG_tolerance_rel", m_MG_tolerance_rel);
     mg_param_given += queryWithParser(pp, "MG_tolerance_abs", m_MG_tolerance_abs);
     mg_param_given += queryWithParser(pp, "MG_verbose", m_MG_verbose);
+    mg_param_given += queryWithParser(pp, "MG_warm_start", m_MG_warm_start);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_MG_warm_start >= 0 && m_MG_warm_start <= 2,
+        "lasers.MG_warm_start must be 0, 1 or 2");
     mg_param_given += queryWithParser(pp, "MG_average_rhs", m_MG_average_rhs);
 
     // Raise warning if user specifies MG parameters without using the MG solver
@@ -54,6 +60,17 @@ MultiLaser::ReadParameters ()
         amrex::Print()<<"WARNING: parameters laser.MG_... only active if laser.solver_type = multigrid\n";
     }
 
+    queryWithParser(pp, "active_window_threshold", m_active_window_threshold);
+    queryWithParser(pp, "active_window_padding", m_active_window_padding);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_active_window_threshold <= 0. ||
+        m_solver_type == "multigrid",
+        "lasers.active_window_threshold is only supported with lasers.solver_type = multigrid");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_active_window_padding >= 1,
+        "lasers.active_window_padding must be at least 1");
+    queryWithParser(pp, "active_window_max_solvers", m_active_window_max_solvers);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_active_window_max_solvers >= 1,
+        "lasers.active_window_max_solvers must be at least 1");
+
     queryWithParser(pp, "insitu_period", m_insitu_period);
     queryWithParser(pp, "insitu_file_prefix", m_insitu_file_prefix);
 }
@@ -116,6 +133,7 @@ MultiLaser::MakeLaserGeometry (const amrex::Geometry& field_geom_3D)
     m_slice_box = domain_3D_laser;
     m_slice_box.setSmall(2, 0);
     m_slice_box.setBig(2, 0);
+    m_active_box = m_slice_box;
 
     m_laser_slice_ba.define(m_slice_box);
     m_laser_slice_dm.define(amrex::Vector<int>({amrex::ParallelDescriptor::MyProc()}));
@@ -169,6 +187,7 @@ MultiLaser::InitData ()
         m_insitu_rdata.resize(m_laser_geom_3D.Domain().length(2)*m_insitu_nrp, 0.);
         m_insitu_sum_rdata.resize(m_insitu_nrp, 0.);
         m_insitu_cdata.resize(m_laser_geom_3D.Domain().length(2)*m_insitu_ncp, 0.);
+        m_insitu_acc.resize(m_laser_geom_3D.Domain().length(2));
     }
 }
 
@@ -215,6 +234,79 @@ MultiLaser::ShiftLaserSlices (const int islice)
     }
 }
 
+void
+MultiLaser::UpdateActiveWindow (const int islice)
+{
+    m_active_box = m_slice_box;
+    if (!UseLaser(islice) || m_active_window_threshold <= 0.) return;
+
+    HIPACE_PROFILE("MultiLaser::UpdateActiveWindow()");
+
+    const amrex::Real threshold_sq = m_active_window_threshold * m_active_window_threshold;
+
+    amrex::ReduceOps<amrex::ReduceOpMin, amrex::ReduceOpMin,
+                     amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_op;
+    amrex::ReduceData<int, int, int, int> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for ( amrex::MFIter mfi(m_slices, DfltMfi); mfi.isValid(); ++mfi ){
+        Array3<amrex::Real const> const arr = m_slices.const_array(mfi);
+        reduce_op.eval(mfi.tilebox(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int) -> ReduceTuple
+            {
+                using namespace WhichLaserSlice;
+                // all slices that are read by AdvanceSlice, np1j00 is the solution
+                constexpr int comps[8] = {nm1j00_r, nm1jp1_r, nm1jp2_r, n00j00_r,
+                                          n00jp1_r, n00jp2_r, np1jp1_r, np1jp2_r};
+                bool is_active = false;
+                for (int n = 0; n < 8; ++n) {
+                    is_active = is_active ||
+                        abssq(arr(i, j, comps[n]), arr(i, j, comps[n] + 1)) > threshold_sq;
+                }
+                if (is_active) return {i, j, i, j};
+                return {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+                        std::numeric_limits<int>::lowest(), std::numeric_limits<int>::lowest()};
+            });
+    }
+
+    auto const res = reduce_data.value();
+    const int x_lo = amrex::get<0>(res);
+    const int y_lo = amrex::get<1>(res);
+    const int x_hi = amrex::get<2>(res);
+    const int y_hi = amrex::get<3>(res);
+
+    if (x_lo > x_hi || y_lo > y_hi) {
+        // no laser on this slice, nothing to solve
+        m_active_box = amrex::Box();
+        return;
+    }
+
+    amrex::Box window {amrex::IntVect(x_lo, y_lo, 0), amrex::IntVect(x_hi, y_hi, 0)};
+    window.grow(amrex::IntVect(m_active_window_padding, m_active_window_padding, 0));
+
+    // round the size up to full blocks so that the MG solvers can be reused between slices
+    for (int dir=0; dir<2; ++dir) {
+        const int len = (window.length(dir) + m_active_window_block - 1)
+                        / m_active_window_block * m_active_window_block;
+        if (len >= m_slice_box.length(dir)) {
+            window.setSmall(dir, m_slice_box.smallEnd(dir));
+            window.setBig(dir, m_slice_box.bigEnd(dir));
+        } else {
+            const int lo = std::clamp(window.smallEnd(dir) - (len - window.length(dir)) / 2,
+                                      m_slice_box.smallEnd(dir), m_slice_box.bigEnd(dir) - len + 1);
+            window.setSmall(dir, lo);
+            window.setBig(dir, lo + len - 1);
+        }
+    }
+
+    // the MG solver requires the same parity in x and y
+    if (window.length(0) % 2 != window.length(1) % 2) {
+        window = m_slice_box;
+    }
+
+    m_active_box = window;
+}
+
 void
 MultiLaser::UpdateLaserAabs (const int islice, const int current_N_level, Fields& fields,
                              amrex::Vector<amrex::Geometry> const& field_geom)
@@ -224,7 +316,7 @@ MultiLaser::UpdateLaserAabs (const int islice, const int current_N_level, Fields
 
     HIPACE_PROFILE("MultiLaser::UpdateLaserAabs()");
 
-    if (!HasSlice(islice)) {
+    if (!HasSlice(islice) || !m_active_box.ok()) {
         // set aabs to zero if there is no laser on this slice
         // we only need to do this if the previous slice (slice + 1) had a laser
         for (int lev=0; lev<current_N_level; ++lev) {
@@ -249,16 +341,44 @@ MultiLaser::UpdateLaserAabs (const int islice, const int current_N_level, Fields
         const amrex::Real dx_laser_inv = m_laser_geom_3D.InvCellSize(0);
         const amrex::Real dy_laser_inv = m_laser_geom_3D.InvCellSize(1);
 
-        const int x_lo = m_slice_box.smallEnd(0);
-        const int x_hi = m_slice_box.bigEnd(0);
-        const int y_lo = m_slice_box.smallEnd(1);
-        const int y_hi = m_slice_box.bigEnd(1);
+        // the laser is zero outside of the active window
+        const int x_lo = m_active_box.smallEnd(0);
+        const int x_hi = m_active_box.bigEnd(0);
+        const int y_lo = m_active_box.smallEnd(1);
+        const int y_hi = m_active_box.bigEnd(1);
+
+        amrex::Box field_box = mfi.growntilebox();
+        if (m_active_box != m_slice_box) {
+            // only interpolate to the field cells that are close to the active window
+            const amrex::Real dx_laser = m_laser_geom_3D.CellSize(0);
+            const amrex::Real dy_laser = m_laser_geom_3D.CellSize(1);
+            const amrex::Real dx_field_inv = field_geom[0].InvCellSize(0);
+            const amrex::Real dy_field_inv = field_geom[0].InvCellSize(1);
+            const int ng = m_interp_order + 1;
+            const amrex::Box window_field_box {
+                amrex::IntVect(
+                    int(amrex::Math::floor((x_lo*dx_laser + poff_laser_x - poff_field_x)
+                        * dx_field_inv)) - ng,
+                    int(amrex::Math::floor((y_lo*dy_laser + poff_laser_y - poff_field_y)
+                        * dy_field_inv)) - ng,
+                    field_box.smallEnd(2)),
+                amrex::IntVect(
+                    int(amrex::Math::ceil((x_hi*dx_laser + poff_laser_x - poff_field_x)
+                        * dx_field_inv)) + ng,
+                    int(amrex::Math::ceil((y_hi*dy_laser + poff_laser_y - poff_field_y)
+                        * dy_field_inv)) + ng,
+                    field_box.bigEnd(2))};
+            fields.getSlices(0)[mfi].setVal<amrex::RunOn::Device>(
+                0., field_box, Comps[WhichSlice::This]["aabs"], 1);
+            field_box &= window_field_box;
+            if (!field_box.ok()) continue;
+        }
 
         const bool linear_polarization = m_linear_polarization;
         amrex::ParallelFor(
             amrex::TypeList<amrex::CompileTimeOptions<0, 1, 2, 3>>{},
             {m_interp_order},
-            mfi.growntilebox(),
+            field_box,
             [=] AMREX_GPU_DEVICE(int i, int j, int, auto interp_order) noexcept {
                 using namespace WhichLaserSlice;
 
@@ -379,10 +499,14 @@ MultiLaser::InterpolateChi (const Fields& fields, amrex::Geometry const& geom_fi
         const int y_lo = amrex::Math::ceil((pos_y_lo - poff_laser_y) * dy_laser_inv);
         const int y_hi = amrex::Math::floor((pos_y_hi - poff_laser_y) * dy_laser_inv);
 
+        // chi is only needed inside the active window
+        const amrex::Box chi_box = m_active_box == m_slice_box ? mfi.growntilebox()
+                                                               : m_active_box;
+
         amrex::ParallelFor(
             amrex::TypeList<amrex::CompileTimeOptions<0, 1, 2, 3>>{},
             {m_interp_order},
-            mfi.growntilebox(),
+            chi_box,
             [=] AMREX_GPU_DEVICE(int i, int j, int, auto interp_order) noexcept {
                 const amrex::Real x = i * dx_laser + poff_laser_x;
                 const amrex::Real y = j * dy_laser + poff_laser_y;
@@ -421,12 +545,21 @@ MultiLaser::AdvanceSlice (const int islice, const Fields& fields, amrex::Real dt
 
     if (!UseLaser(islice)) return;
 
-    Hipace::m_num_laser_cells_updated += m_slice_box.d_numPts();
+    if (!m_active_box.ok()) {
+        // no laser in the active window, the envelope stays zero
+        for ( amrex::MFIter mfi(m_slices, DfltMfi); mfi.isValid(); ++mfi ){
+            m_slices[mfi].setVal<amrex::RunOn::Device>(
+                0., mfi.growntilebox(), WhichLaserSlice::np1j00_r, 2);
+        }
+        return;
+    }
+
+    Hipace::m_num_laser_cells_updated += m_active_box.d_numPts();
 
     InterpolateChi(fields, geom_field_lev0);
 
     if (m_solver_type == "multigrid") {
-        AdvanceSliceMG(dt, step);
+        AdvanceSliceMG(dt, step, islice);
     } else if (m_solver_type == "fft") {
         AdvanceSliceFFT(dt, step);
     } else {
@@ -434,8 +567,87 @@ MultiLaser::AdvanceSlice (const int islice, const Fields& fields, amrex::Real dt
     }
 }
 
+const amrex::Real*
+MultiLaser::ComputePhaseTerms (const amrex::Box& bx, Array3<amrex::Real const> const arr,
+                               const amrex::Real dz)
+{
+    using namespace amrex::literals;
+    using Complex = amrex::GpuComplex<amrex::Real>;
+
+    m_phase_terms.resize(5);
+    amrex::Real* const phase_terms = m_phase_terms.dataPtr();
+
+    const int imin = bx.smallEnd(0);
+    const int imax = bx.bigEnd  (0);
+    const int jmin = bx.smallEnd(1);
+    const int jmax = bx.bigEnd  (1);
+    const int Nx = bx.length(0);
+    const int Ny = bx.length(1);
+    const bool use_phase = m_use_phase;
+
+    // A single thread is enough as only the (up to) four cells nearest to the axis are used.
+    // This avoids a reduction over the whole slice and a synchronization with the host.
+    amrex::ParallelFor(1,
+        [=] AMREX_GPU_DEVICE (int) noexcept
+        {
+            using namespace WhichLaserSlice;
+            constexpr Complex I(0.,1.);
+
+            // Calculate phase terms. 0 if !use_phase
+            amrex::Real tj00 = 0.;
+            amrex::Real tjp1 = 0.;
+            amrex::Real tjp2 = 0.;
+
+            if (use_phase) {
+                // Get the central point.
+                const int imid = (Nx+1)/2;
+                const int jmid = (Ny+1)/2;
+                // Even number of transverse cells: average 2 cells
+                // Odd number of cells: only keep central one
+                const int ilo = Nx % 2 == 0 ? imid-1 : imid;
+                const int jlo = Ny % 2 == 0 ? jmid-1 : jmid;
+
+                // Calculate complex arguments (theta) needed
+                // Just once, on axis, as done in Wake-T
+                amrex::Real sum[6] = {0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt};
+                for (int j = amrex::max(jlo, jmin); j <= amrex::min(jmid, jmax); ++j) {
+                    for (int i = amrex::max(ilo, imin); i <= amrex::min(imid, imax); ++i) {
+                        sum[0] += arr(i, j, n00j00_r);
+                        sum[1] += arr(i, j, n00j00_i);
+                        sum[2] += arr(i, j, n00jp1_r);
+                        sum[3] += arr(i, j, n00jp1_i);
+                        sum[4] += arr(i, j, n00jp2_r);
+                        sum[5] += arr(i, j, n00jp2_i);
+                    }
+                }
+                // ... and taking the argument of the resulting complex number.
+                tj00 = std::atan2(sum[1], sum[0]);
+                tjp1 = std::atan2(sum[3], sum[2]);
+                tjp2 = std::atan2(sum[5], sum[4]);
+            }
+
+            amrex::Real dt1 = tj00 - tjp1;
+            amrex::Real dt2 = tjp1 - tjp2;
+            if (dt1 <-1.5_rt*MathConst::pi) dt1 += 2._rt*MathConst::pi;
+            if (dt1 > 1.5_rt*MathConst::pi) dt1 -= 2._rt*MathConst::pi;
+            if (dt2 <-1.5_rt*MathConst::pi) dt2 += 2._rt*MathConst::pi;
+            if (dt2 > 1.5_rt*MathConst::pi) dt2 -= 2._rt*MathConst::pi;
+            const Complex exp1 = amrex::exp(I*(tj00-tjp1));
+            const Complex exp2 = amrex::exp(I*(tj00-tjp2));
+
+            phase_terms[0] = exp1.real();
+            phase_terms[1] = exp1.imag();
+            phase_terms[2] = exp2.real();
+            phase_terms[3] = exp2.imag();
+            // D_j^n as defined in Benedetti's 2017 paper
+            phase_terms[4] = ( -3._rt*dt1 + dt2 ) / (2._rt*dz);
+        });
+
+    return phase_terms;
+}
+
 void
-MultiLaser::AdvanceSliceMG (amrex::Real dt, int step)
+MultiLaser::AdvanceSliceMG (amrex::Real dt, int step, int islice)
 {
 
     HIPACE_PROFILE("MultiLaser::AdvanceSliceMG()");
@@ -456,7 +668,14 @@ MultiLaser::AdvanceSliceMG (amrex::Real dt, int step)
     amrex::Real acoeff_real_scalar = 0._rt;
     amrex::Real acoeff_imag_scalar = 0._rt;
 
-    amrex::Real djn {0.};
+    amrex::Real djn_host {0.};
+
+    // the MG solve is restricted to the active window with zero Dirichlet boundaries,
+    // need one ghost cell for 2^n-1 MG solve
+    const amrex::Box solve_box = m_active_box;
+    const bool use_window = solve_box != m_slice_box;
+    m_mg_acoeff_real.resize(amrex::grow(solve_box, amrex::IntVect{1, 1, 0}), 1);
+    m_rhs_mg.resize(amrex::grow(solve_box, amrex::IntVect{1, 1, 0}), 2);
 
     for ( amrex::MFIter mfi(m_slices, DfltMfi); mfi.isValid(); ++mfi ){
         const amrex::Box& bx = mfi.tilebox();
@@ -469,78 +688,20 @@ MultiLaser::AdvanceSliceMG (amrex::Real dt, int step)
         Array3<amrex::Real> rhs_mg_arr = m_rhs_mg.array();
         Array3<amrex::Real> acoeff_real_arr = m_mg_acoeff_real.array();
 
-        // Calculate phase terms. 0 if !m_use_phase
-        amrex::Real tj00 = 0.;
-        amrex::Real tjp1 = 0.;
-        amrex::Real tjp2 = 0.;
-
-        if (m_use_phase) {
-            int const Nx = bx.length(0);
-            int const Ny = bx.length(1);
-
-            // Get the central point.
-            int const imid = (Nx+1)/2;
-            int const jmid = (Ny+1)/2;
-
-            // Calculate complex arguments (theta) needed
-            // Just once, on axis, as done in Wake-T
-            // This is done with a reduce operation, returning the sum of the four elements nearest
-            // the axis (both real and imag parts, and for the 3 arrays relevant) ...
-            amrex::ReduceOps<
-                amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum,
-                amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
-            amrex::ReduceData<
-                amrex::Real, amrex::Real, amrex::Real,
-                amrex::Real, amrex::Real, amrex::Real> reduce_data(reduce_op);
-            using ReduceTuple = typename decltype(reduce_data)::Type;
-            reduce_op.eval(bx, reduce_data,
-                [=] AMREX_GPU_DEVICE (int i, int j, int) -> ReduceTuple
-                {
-                    using namespace WhichLaserSlice;
-                    // Even number of transverse cells: average 2 cells
-                    // Odd number of cells: only keep central one
-                    const bool do_keep_x = Nx % 2 == 0 ?
-                        i == imid-1 || i == imid : i == imid;
-                    const bool do_keep_y = Ny % 2 == 0 ?
-                        j == jmid-1 || j == jmid : j == jmid;
-                    if ( do_keep_x && do_keep_y ) {
-                        return {
-                            arr(i, j, n00j00_r), arr(i, j, n00j00_i),
-                            arr(i, j, n00jp1_r), arr(i, j, n00jp1_i),
-                            arr(i, j, n00jp2_r), arr(i, j, n00jp2_i)
-                        };
-                    } else {
-                        return {0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt};
-                    }
-                });
-            // ... and taking the argument of the resulting complex number.
-            ReduceTuple hv = reduce_data.value(reduce_op);
-            tj00 = std::atan2(amrex::get<1>(hv), amrex::get<0>(hv));
-            tjp1 = std::atan2(amrex::get<3>(hv), amrex::get<2>(hv));
-            tjp2 = std::atan2(amrex::get<5>(hv), amrex::get<4>(hv));
-        }
+        // Calculate phase terms on the device. exp1, exp2 and djn are 1, 1 and 0 if !m_use_phase
+        const amrex::Real* const phase_terms = ComputePhaseTerms(bx, arr, dz);
 
-        amrex::Real dt1 = tj00 - tjp1;
-        amrex::Real dt2 = tjp1 - tjp2;
-        if (dt1 <-1.5_rt*MathConst::pi) dt1 += 2._rt*MathConst::pi;
-        if (dt1 > 1.5_rt*MathConst::pi) dt1 -= 2._rt*MathConst::pi;
-        if (dt2 <-1.5_rt*MathConst::pi) dt2 += 2._rt*MathConst::pi;
-        if (dt2 > 1.5_rt*MathConst::pi) dt2 -= 2._rt*MathConst::pi;
-        Complex exp1 = amrex::exp(I*(tj00-tjp1));
-        Complex exp2 = amrex::exp(I*(tj00-tjp2));
-
-        // D_j^n as defined in Benedetti's 2017 paper
-        djn = ( -3._rt*dt1 + dt2 ) / (2._rt*dz);
         acoeff_real_scalar = step == 0 ? 6._rt/(c*dt*dz)
             : 3._rt/(c*dt*dz) + 2._rt/(c*c*dt*dt);
-        acoeff_imag_scalar = step == 0 ? -4._rt * ( k0 + djn ) / (c*dt)
-            : -2._rt * ( k0 + djn ) / (c*dt);
 
         amrex::ParallelFor(
-            to2D(bx),
+            to2D(solve_box),
             [=] AMREX_GPU_DEVICE(int i, int j) noexcept
             {
                 using namespace WhichLaserSlice;
+                const Complex exp1 {phase_terms[0], phase_terms[1]};
+                const Complex exp2 {phase_terms[2], phase_terms[3]};
+                const amrex::Real djn = phase_terms[4];
                 // Transverse Laplacian of real and imaginary parts of A_j^n-1
                 amrex::Real lapR, lapI;
                 if (step == 0) {
@@ -600,18 +761,63 @@ MultiLaser::AdvanceSliceMG (amrex::Real dt, int step)
                 rhs_mg_arr(i,j,0) = rhs.real();
                 rhs_mg_arr(i,j,1) = rhs.imag();
             });
+
+        // D_j^n is needed on the host for the imaginary part of the MG coefficient
+        amrex::Gpu::dtoh_memcpy_async(&djn_host, phase_terms + 4, sizeof(amrex::Real));
+        amrex::Gpu::streamSynchronize();
+        acoeff_imag_scalar = step == 0 ? -4._rt * ( k0 + djn_host ) / (c*dt)
+            : -2._rt * ( k0 + djn_host ) / (c*dt);
     }
 
-    if (!m_mg) {
-        m_mg = std::make_unique<hpmg::MultiGrid>(m_laser_geom_3D.CellSize(0),
-                                                 m_laser_geom_3D.CellSize(1),
-                                                 m_slices.boxArray()[0], 2);
+    // hpmg only depends on the size of the box, so the solvers are reused for all windows
+    // of the same size. Only the most recently used ones are kept, as the window size can
+    // change during a long simulation
+    const std::pair<int, int> mg_size {solve_box.length(0), solve_box.length(1)};
+    auto mg_it = std::find_if(m_mg.begin(), m_mg.end(),
+                              [&] (const auto& entry) { return entry.first == mg_size; });
+    if (mg_it != m_mg.end()) {
+        m_mg.splice(m_mg.begin(), m_mg, mg_it);
+    } else {
+        if (static_cast<int>(m_mg.size()) >= m_active_window_max_solvers) {
+            // the memory of the least recently used solver may still be in use on the GPU
+            amrex::Gpu::streamSynchronize();
+            m_mg.pop_back();
+        }
+        m_mg.emplace_front(mg_size, std::make_unique<hpmg::MultiGrid>(
+            m_laser_geom_3D.CellSize(0), m_laser_geom_3D.CellSize(1), solve_box, 2));
+        m_mg.front().second->set_warm_start(m_MG_warm_start);
     }
+    auto& mg = m_mg.front().second;
 
     const int max_iters = 200;
     amrex::MultiFab np1j00 (m_slices, amrex::make_alias, WhichLaserSlice::np1j00_r, 2);
-    m_mg->solve2(np1j00[0], m_rhs_mg, m_mg_acoeff_real, acoeff_imag_scalar,
-                 m_MG_tolerance_rel, m_MG_tolerance_abs, max_iters, m_MG_verbose);
+
+    if (!use_window) {
+        mg->warm_start(np1j00[0], islice);
+        mg->solve2(np1j00[0], m_rhs_mg, m_mg_acoeff_real, acoeff_imag_scalar,
+                   m_MG_tolerance_rel, m_MG_tolerance_abs, max_iters, m_MG_verbose);
+        return;
+    }
+
+    // use the previous solution in the window as initial guess
+    const amrex::Box sol_box = amrex::grow(solve_box, amrex::IntVect{1, 1, 0});
+    m_mg_sol_window.resize(sol_box, 2);
+    m_mg_sol_window.copy<amrex::RunOn::Device>(np1j00[0], sol_box, 0, sol_box, 0, 2);
+
+    mg->warm_start(m_mg_sol_window, islice);
+    mg->solve2(m_mg_sol_window, m_rhs_mg, m_mg_acoeff_real, acoeff_imag_scalar,
+               m_MG_tolerance_rel, m_MG_tolerance_abs, max_iters, m_MG_verbose);
+
+    // copy the solution back, the envelope is zero outside of the active window
+    for ( amrex::MFIter mfi(np1j00, DfltMfi); mfi.isValid(); ++mfi ){
+        Array3<amrex::Real> arr = np1j00.array(mfi);
+        Array3<amrex::Real const> sol_arr = m_mg_sol_window.const_array();
+        amrex::ParallelFor(to2D(mfi.growntilebox()), 2,
+            [=] AMREX_GPU_DEVICE(int i, int j, int n) noexcept
+            {
+                arr(i, j, n) = solve_box.contains(i, j, 0) ? sol_arr(i, j, n) : 0._rt;
+            });
+    }
 }
 
 void
@@ -652,70 +858,21 @@ MultiLaser::AdvanceSliceFFT (const amrex::Real dt, int step)
         int const Nx = bx.length(0);
         int const Ny = bx.length(1);
 
-        // Get the central point. Useful to get the on-axis phase and calculate kx and ky.
+        // Get the central point. Useful to calculate kx and ky.
         int const imid = (Nx+1)/2;
         int const jmid = (Ny+1)/2;
 
-        // Calculate phase terms. 0 if !m_use_phase
-        amrex::Real tj00 = 0.;
-        amrex::Real tjp1 = 0.;
-        amrex::Real tjp2 = 0.;
-
-        if (m_use_phase) {
-            // Calculate complex arguments (theta) needed
-            // Just once, on axis, as done in Wake-T
-            // This is done with a reduce operation, returning the sum of the four elements nearest
-            // the axis (both real and imag parts, and for the 3 arrays relevant) ...
-            amrex::ReduceOps<
-                amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum,
-                amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
-            amrex::ReduceData<
-                amrex::Real, amrex::Real, amrex::Real,
-                amrex::Real, amrex::Real, amrex::Real> reduce_data(reduce_op);
-            using ReduceTuple = typename decltype(reduce_data)::Type;
-            reduce_op.eval(bx, reduce_data,
-                [=] AMREX_GPU_DEVICE (int i, int j, int) -> ReduceTuple
-                {
-                    using namespace WhichLaserSlice;
-                    // Even number of transverse cells: average 2 cells
-                    // Odd number of cells: only keep central one
-                    const bool do_keep_x = Nx % 2 == 0 ?
-                        i == imid-1 || i == imid : i == imid;
-                    const bool do_keep_y = Ny % 2 == 0 ?
-                        j == jmid-1 || j == jmid : j == jmid;
-                    if ( do_keep_x && do_keep_y ) {
-                        return {
-                            arr(i, j, n00j00_r), arr(i, j, n00j00_i),
-                            arr(i, j, n00jp1_r), arr(i, j, n00jp1_i),
-                            arr(i, j, n00jp2_r), arr(i, j, n00jp2_i)
-                        };
-                    } else {
-                        return {0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt};
-                    }
-                });
-            // ... and taking the argument of the resulting complex number.
-            ReduceTuple hv = reduce_data.value(reduce_op);
-            tj00 = std::atan2(amrex::get<1>(hv), amrex::get<0>(hv));
-            tjp1 = std::atan2(amrex::get<3>(hv), amrex::get<2>(hv));
-            tjp2 = std::atan2(amrex::get<5>(hv), amrex::get<4>(hv));
-        }
+        // Calculate phase terms on the device. exp1, exp2 and djn are 1, 1 and 0 if !m_use_phase
+        const amrex::Real* const phase_terms = ComputePhaseTerms(bx, arr, dz);
 
-        amrex::Real dt1 = tj00 - tjp1;
-        amrex::Real dt2 = tjp1 - tjp2;
-        if (dt1 <-1.5_rt*MathConst::pi) dt1 += 2._rt*MathConst::pi;
-        if (dt1 > 1.5_rt*MathConst::pi) dt1 -= 2._rt*MathConst::pi;
-        if (dt2 <-1.5_rt*MathConst::pi) dt2 += 2._rt*MathConst::pi;
-        if (dt2 > 1.5_rt*MathConst::pi) dt2 -= 2._rt*MathConst::pi;
-        Complex exp1 = amrex::exp(I*(tj00-tjp1));
-        Complex exp2 = amrex::exp(I*(tj00-tjp2));
-
-        // D_j^n as defined in Benedetti's 2017 paper
-        amrex::Real djn = ( -3._rt*dt1 + dt2 ) / (2._rt*dz);
         amrex::ParallelFor(
             to2D(bx),
             [=] AMREX_GPU_DEVICE(int i, int j) noexcept
             {
                 using namespace WhichLaserSlice;
+                const Complex exp1 {phase_terms[0], phase_terms[1]};
+                const Complex exp2 {phase_terms[2], phase_terms[3]};
+                const amrex::Real djn = phase_terms[4];
                 // Transverse Laplacian of real and imaginary parts of A_j^n-1
                 amrex::Real lapR, lapI;
                 if (step == 0) {
@@ -770,14 +927,15 @@ MultiLaser::AdvanceSliceFFT (const amrex::Real dt, int step)
         // Multiply by appropriate factors in Fourier space
         amrex::Real dkx = 2.*MathConst::pi/m_laser_geom_3D.ProbLength(0);
         amrex::Real dky = 2.*MathConst::pi/m_laser_geom_3D.ProbLength(1);
-        // acoeff_imag is supposed to be a nx*ny array.
-        // For the sake of simplicity, we evaluate it on-axis only.
-        const Complex acoeff =
-            step == 0 ? 6._rt/(c*dt*dz) - I * 4._rt * ( k0 + djn ) / (c*dt) :
-             3._rt/(c*dt*dz) + 2._rt/(c*c*dt*dt) - I * 2._rt * ( k0 + djn ) / (c*dt);
         amrex::ParallelFor(
             to2D(bx),
             [=] AMREX_GPU_DEVICE(int i, int j) noexcept {
+                // acoeff_imag is supposed to be a nx*ny array.
+                // For the sake of simplicity, we evaluate it on-axis only.
+                const amrex::Real djn = phase_terms[4];
+                const Complex acoeff =
+                    step == 0 ? 6._rt/(c*dt*dz) - I * 4._rt * ( k0 + djn ) / (c*dt) :
+                     3._rt/(c*dt*dz) + 2._rt/(c*c*dt*dt) - I * 2._rt * ( k0 + djn ) / (c*dt);
                 // divide rhs_fourier by -(k^2+a)
                 amrex::Real kx = (i<imid) ? dkx*i : dkx*(i-Nx);
                 amrex::Real ky = (j<jmid) ? dky*j : dky*(j-Ny);
@@ -936,35 +1094,26 @@ MultiLaser::InSituComputeDiags (int step, amrex::Real time, int islice,
     HIPACE_PROFILE("MultiLaser::InSituComputeDiags()");
 
     using namespace amrex::literals;
-    using Complex = amrex::GpuComplex<amrex::Real>;
 
-    AMREX_ALWAYS_ASSERT(m_insitu_rdata.size()>0 && m_insitu_sum_rdata.size()>0 &&
-                        m_insitu_cdata.size()>0);
+    AMREX_ALWAYS_ASSERT(!m_insitu_acc.empty());
 
-    const int nslices = m_laser_geom_3D.Domain().length(2);
     const int laser_slice = islice - m_laser_geom_3D.Domain().smallEnd(2);
     const amrex::Real poff_x = GetPosOffset(0, m_laser_geom_3D, m_laser_geom_3D.Domain());
     const amrex::Real poff_y = GetPosOffset(1, m_laser_geom_3D, m_laser_geom_3D.Domain());
     const amrex::Real dx = m_laser_geom_3D.CellSize(0);
     const amrex::Real dy = m_laser_geom_3D.CellSize(1);
-    const amrex::Real dxdydz = dx * dy * m_laser_geom_3D.CellSize(2);
 
     const int xmid_lo = m_laser_geom_3D.Domain().smallEnd(0) + (m_laser_geom_3D.Domain().length(0) - 1) / 2;
     const int xmid_hi = m_laser_geom_3D.Domain().smallEnd(0) + (m_laser_geom_3D.Domain().length(0)) / 2;
     const int ymid_lo = m_laser_geom_3D.Domain().smallEnd(1) + (m_laser_geom_3D.Domain().length(1) - 1) / 2;
     const int ymid_hi = m_laser_geom_3D.Domain().smallEnd(1) + (m_laser_geom_3D.Domain().length(1)) / 2;
-    const amrex::Real mid_factor = (xmid_lo == xmid_hi ? 1._rt : 0.5_rt)
-                                 * (ymid_lo == ymid_hi ? 1._rt : 0.5_rt);
-
-    amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpMax, amrex::ReduceOpSum[m_insitu_nrp-1+m_insitu_ncp]> reduce_op;
-    amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[m_insitu_nrp], Complex[m_insitu_ncp]> reduce_data(reduce_op);
-    using ReduceTuple = typename decltype(reduce_data)::Type;
 
+    // the results stay on the device until InSituWriteToFile, so there is no synchronization here
     for ( amrex::MFIter mfi(m_slices, DfltMfi); mfi.isValid(); ++mfi ) {
         Array3<amrex::Real const> const arr = m_slices.const_array(mfi);
-        reduce_op.eval(
-            mfi.tilebox(), reduce_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int) -> ReduceTuple
+        m_insitu_acc.Reduce(laser_slice, mfi.tilebox(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int)
+                -> amrex::GpuArray<amrex::Real, m_insitu_nrp + 2*m_insitu_ncp>
             {
                 using namespace WhichLaserSlice;
                 const amrex::Real areal = arr(i,j, n00j00_r);
@@ -975,39 +1124,19 @@ MultiLaser::InSituComputeDiags (int step, amrex::Real time, int islice,
                 const amrex::Real y = j * dy + poff_y;
 
                 const bool is_on_axis = (i==xmid_lo || i==xmid_hi) && (j==ymid_lo || j==ymid_hi);
-                const Complex aaxis{is_on_axis ? areal : 0._rt, is_on_axis ? aimag : 0._rt};
-
-                return {            // Tuple contains:
-                    aabssq,         // 0    max(|a|^2)
-                    aabssq,         // 1    [|a|^2]
-                    aabssq*x,       // 2    [|a|^2*x]
-                    aabssq*x*x,     // 3    [|a|^2*x*x]
-                    aabssq*y,       // 4    [|a|^2*y]
-                    aabssq*y*y,     // 5    [|a|^2*y*y]
-                    aaxis           // 6    axis(a)
+
+                return {                        // Array contains:
+                    aabssq,                     // 0    max(|a|^2)
+                    aabssq,                     // 1    [|a|^2]
+                    aabssq*x,                   // 2    [|a|^2*x]
+                    aabssq*x*x,                 // 3    [|a|^2*x*x]
+                    aabssq*y,                   // 4    [|a|^2*y]
+                    aabssq*y*y,                 // 5    [|a|^2*y*y]
+                    is_on_axis ? areal : 0._rt, // 6    real(axis(a))
+                    is_on_axis ? aimag : 0._rt  // 7    imag(axis(a))
                 };
             });
     }
-
-    auto [real_tup, cplx_tup] = amrex::TupleSplit<m_insitu_nrp, m_insitu_ncp>(reduce_data.value());
-
-    auto real_arr = amrex::tupleToArray(real_tup);
-
-    for (int i=0; i<m_insitu_nrp; ++i) {
-        if (i == 0) {
-            m_insitu_rdata[laser_slice + i * nslices] = real_arr[i];
-            m_insitu_sum_rdata[i] = std::max(m_insitu_sum_rdata[i], real_arr[i]);
-        } else {
-            m_insitu_rdata[laser_slice + i * nslices] = real_arr[i] * dxdydz;
-            m_insitu_sum_rdata[i] += real_arr[i] * dxdydz;
-        }
-    }
-
-    auto cplx_arr = amrex::tupleToArray(cplx_tup);
-
-    for (int i=0; i<m_insitu_ncp; ++i) {
-        m_insitu_cdata[laser_slice + i * nslices] = cplx_arr[i] * mid_factor;
-    }
 }
 
 void
@@ -1017,6 +1146,8 @@ MultiLaser::InSituWriteToFile (int step, amrex::Real time, int max_step, amrex::
     if (!utils::doDiagnostics(m_insitu_period, step, max_step, time, max_time)) return;
     HIPACE_PROFILE("MultiLaser::InSituWriteToFile()");
 
+    using namespace amrex::literals;
+
 #ifdef HIPACE_USE_OPENPMD
     // create subdirectory
     openPMD::auxiliary::create_directories(m_insitu_file_prefix);
@@ -1034,6 +1165,33 @@ MultiLaser::InSituWriteToFile (int step, amrex::Real time, int max_step, amrex::
     const int nslices_int = m_laser_geom_3D.Domain().length(2);
     const std::size_t nslices = static_cast<std::size_t>(nslices_int);
     const int is_normalized_units = Hipace::m_normalized_units;
+    const amrex::Real dxdydz = m_laser_geom_3D.CellSize(0) * m_laser_geom_3D.CellSize(1)
+                               * m_laser_geom_3D.CellSize(2);
+    const amrex::Real mid_factor = (m_laser_geom_3D.Domain().length(0) % 2 == 1 ? 1._rt : 0.5_rt)
+                                 * (m_laser_geom_3D.Domain().length(1) % 2 == 1 ? 1._rt : 0.5_rt);
+
+    // get the data of all slices from the device
+    m_insitu_acc.CopyToHost();
+    for (int islice=0; islice<nslices_int; ++islice) {
+        for (int i=0; i<m_insitu_nrp; ++i) {
+            if (i == 0) {
+                m_insitu_rdata[islice + i * nslices] =
+                    static_cast<amrex::Real>(m_insitu_acc.get(islice, i));
+                m_insitu_sum_rdata[i] = std::max(m_insitu_sum_rdata[i],
+                                                 m_insitu_rdata[islice + i * nslices]);
+            } else {
+                m_insitu_rdata[islice + i * nslices] = static_cast<amrex::Real>(
+                    m_insitu_acc.get(islice, i) * dxdydz);
+                m_insitu_sum_rdata[i] += m_insitu_rdata[islice + i * nslices];
+            }
+        }
+        for (int i=0; i<m_insitu_ncp; ++i) {
+            m_insitu_cdata[islice + i * nslices] = amrex::GpuComplex<amrex::Real>{
+                static_cast<amrex::Real>(m_insitu_acc.get(islice, m_insitu_nrp + 2*i)),
+                static_cast<amrex::Real>(m_insitu_acc.get(islice, m_insitu_nrp + 2*i + 1))
+            } * mid_factor;
+        }
+    }
 
     // specify the structure of the data later available in python
     // avoid pointers to temporary objects as second argument, stack variables are ok
@@ -0,0 +1,358 @@
+/* Copyright 2024
+ *
+ * This file is part of HiPACE++.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "FFTBiCGStab.H"
+#include "utils/GPUUtil.H"
+#include "utils/HipaceProfilerWrapper.H"
+
+#include <AMReX_Reduce.H>
+
+#include <iomanip>
+#include <string>
+
+namespace {
+
+/** \brief Apply the operator `-acoef * phi + Lap(phi)` at one cell, with the same
+ * discretization and homogeneous Dirichlet BC as hpmg. Ghost cells of phi are not read.
+ */
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+amrex::Real apply_operator (int i, int j, int n, int ilo, int jlo, int ihi, int jhi,
+                            bool cell_centered, Array3<amrex::Real const> const& phi,
+                            amrex::Real acf, amrex::Real facx, amrex::Real facy)
+{
+    const amrex::Real phi_c = phi(i,j,n);
+    const amrex::Real phi_xlo = i > ilo ? phi(i-1,j,n) : amrex::Real(0.);
+    const amrex::Real phi_xhi = i < ihi ? phi(i+1,j,n) : amrex::Real(0.);
+    const amrex::Real phi_ylo = j > jlo ? phi(i,j-1,n) : amrex::Real(0.);
+    const amrex::Real phi_yhi = j < jhi ? phi(i,j+1,n) : amrex::Real(0.);
+    amrex::Real lap = amrex::Real(-2.)*(facx+facy)*phi_c;
+    if (cell_centered && i == ilo) {
+        lap += facx * (amrex::Real(4./3.)*phi_xhi - amrex::Real(2.)*phi_c);
+    } else if (cell_centered && i == ihi) {
+        lap += facx * (amrex::Real(4./3.)*phi_xlo - amrex::Real(2.)*phi_c);
+    } else {
+        lap += facx * (phi_xlo + phi_xhi);
+    }
+    if (cell_centered && j == jlo) {
+        lap += facy * (amrex::Real(4./3.)*phi_yhi - amrex::Real(2.)*phi_c);
+    } else if (cell_centered && j == jhi) {
+        lap += facy * (amrex::Real(4./3.)*phi_ylo - amrex::Real(2.)*phi_c);
+    } else {
+        lap += facy * (phi_ylo + phi_yhi);
+    }
+    return lap - acf*phi_c;
+}
+
+}
+
+FFTBiCGStab::FFTBiCGStab (amrex::BoxArray const& ba, amrex::DistributionMapping const& dm,
+                          amrex::Geometry const& gm)
+    : m_dx(gm.CellSize(0)), m_dy(gm.CellSize(1))
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ba.size() == 1,
+        "FFTBiCGStab only supports a single box per slice");
+    const amrex::IntVect len = ba[0].length();
+    AMREX_ALWAYS_ASSERT(len[2] == 1 && ba[0].cellCentered() && len[0]%2 == len[1]%2);
+    m_cell_centered = len[0]%2 == 0;
+
+    m_fft = std::make_unique<FFTPoissonSolverDirichletFast>(ba, dm, gm, m_num_comps);
+
+    for (amrex::MultiFab* mf : {&m_r, &m_rhat, &m_p, &m_v, &m_s, &m_t, &m_phat, &m_shat}) {
+        mf->define(ba, dm, m_num_comps, amrex::IntVect{1, 1, 0});
+        mf->setVal(0.);
+    }
+}
+
+void
+FFTBiCGStab::precondition (amrex::MultiFab& z, amrex::MultiFab const& y)
+{
+    amrex::MultiFab& staging_area = m_fft->StagingArea();
+    amrex::MultiFab::Copy(staging_area, y, 0, 0, m_num_comps, 0);
+    amrex::MultiFab z0 (z, amrex::make_alias, 0, 1);
+    amrex::MultiFab z1 (z, amrex::make_alias, 1, 1);
+    m_fft->SolvePoissonEquations({&z0, &z1});
+}
+
+int
+FFTBiCGStab::solve (amrex::FArrayBox& a_sol, amrex::FArrayBox const& a_rhs,
+                    amrex::FArrayBox const& a_acf, amrex::Real const tol_rel,
+                    amrex::Real const tol_abs, int const nummaxiter, int const verbose)
+{
+    HIPACE_PROFILE("FFTBiCGStab::solve()");
+    using namespace amrex::literals;
+    using Real = amrex::Real;
+
+    AMREX_ALWAYS_ASSERT(a_sol.nComp() >= m_num_comps && a_rhs.nComp() >= m_num_comps);
+
+    const amrex::Box vbx = m_r.boxArray()[0];
+    const int ilo = vbx.smallEnd(0);
+    const int jlo = vbx.smallEnd(1);
+    const int ihi = vbx.bigEnd(0);
+    const int jhi = vbx.bigEnd(1);
+    const bool cell_centered = m_cell_centered;
+    const Real facx = 1._rt/(m_dx*m_dx);
+    const Real facy = 1._rt/(m_dy*m_dy);
+
+    const Array3<Real> sol = a_sol.array();
+    const Array3<Real const> rhs = a_rhs.const_array();
+    const Array3<Real const> acf = a_acf.const_array();
+    const Array3<Real> r = m_r.array(0);
+    const Array3<Real> rhat = m_rhat.array(0);
+    const Array3<Real> p = m_p.array(0);
+    const Array3<Real> v = m_v.array(0);
+    const Array3<Real> s = m_s.array(0);
+    const Array3<Real> t = m_t.array(0);
+    const Array3<Real> phat = m_phat.array(0);
+    const Array3<Real> shat = m_shat.array(0);
+
+    // r = rhs - A(sol), rhat = r, p = v = 0
+    Real rhsnorm0, resnorm0;
+    amrex::GpuArray<Real, m_num_comps> resnorm, rho;
+    Real acf_avg;
+    {
+        amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax, amrex::ReduceOpMax,
+                         amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+        amrex::ReduceData<Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(vbx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+            {
+                const Real a = acf(i,j,0);
+                const Real r0 = rhs(i,j,0) - apply_operator(i, j, 0, ilo, jlo, ihi, jhi,
+                                                             cell_centered, sol, a, facx, facy);
+                const Real r1 = rhs(i,j,1) - apply_operator(i, j, 1, ilo, jlo, ihi, jhi,
+                                                             cell_centered, sol, a, facx, facy);
+                r(i,j,0) = r0;
+                r(i,j,1) = r1;
+                rhat(i,j,0) = r0;
+                rhat(i,j,1) = r1;
+                p(i,j,0) = 0._rt;
+                p(i,j,1) = 0._rt;
+                v(i,j,0) = 0._rt;
+                v(i,j,1) = 0._rt;
+                return {std::abs(r0), std::abs(r1),
+                        amrex::max(std::abs(rhs(i,j,0)), std::abs(rhs(i,j,1))),
+                        r0*r0, r1*r1, a};
+            });
+        auto hv = reduce_data.value(reduce_op);
+        resnorm[0] = amrex::get<0>(hv);
+        resnorm[1] = amrex::get<1>(hv);
+        rhsnorm0 = amrex::get<2>(hv);
+        rho[0] = amrex::get<3>(hv);
+        rho[1] = amrex::get<4>(hv);
+        acf_avg = amrex::get<5>(hv) / vbx.numPts();
+    }
+    resnorm0 = amrex::max(resnorm[0], resnorm[1]);
+
+    if (verbose >= 1) {
+        amrex::Print() << "fft_bicgstab: Initial rhs               = " << rhsnorm0 << "\n"
+                       << "fft_bicgstab: Initial residual (resid0) = " << resnorm0 << "\n";
+    }
+
+    Real max_norm;
+    std::string norm_name;
+    if (rhsnorm0 >= resnorm0) {
+        norm_name = "bnorm";
+        max_norm = rhsnorm0;
+    } else {
+        norm_name = "resid0";
+        max_norm = resnorm0;
+    }
+    const Real res_target = std::max(tol_abs, std::max(tol_rel,Real(1.e-16))*max_norm);
+
+    amrex::GpuArray<bool, m_num_comps> converged;
+    for (int n=0; n<m_num_comps; ++n) {
+        converged[n] = resnorm[n] <= res_target;
+    }
+
+    if (converged[0] && converged[1]) {
+        if (verbose >= 1) {
+            amrex::Print() << "fft_bicgstab: No iterations needed\n";
+        }
+        return 0;
+    }
+
+    // the preconditioner is exact for a constant coefficient equal to the average
+    m_fft->SetScreening(std::max(acf_avg, 0._rt));
+
+    amrex::GpuArray<Real, m_num_comps> alpha {1._rt, 1._rt};
+    amrex::GpuArray<Real, m_num_comps> omega {1._rt, 1._rt};
+    amrex::GpuArray<Real, m_num_comps> beta {0._rt, 0._rt};
+
+    int iter = 0;
+    for (; iter < nummaxiter; ++iter) {
+
+        // p = r + beta * (p - omega * v)
+        {
+            const auto beta_ = beta;
+            const auto omega_ = omega;
+            amrex::ParallelFor(to2D(vbx), m_num_comps,
+                [=] AMREX_GPU_DEVICE (int i, int j, int n) noexcept
+                {
+                    p(i,j,n) = r(i,j,n) + beta_[n] * (p(i,j,n) - omega_[n] * v(i,j,n));
+                });
+        }
+
+        precondition(m_phat, m_p);
+
+        // v = A(phat), alpha = rho / (rhat, v)
+        {
+            const Array3<Real const> phat_c = phat;
+            amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+            amrex::ReduceData<Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(vbx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+                {
+                    const Real a = acf(i,j,0);
+                    const Real v0 = apply_operator(i, j, 0, ilo, jlo, ihi, jhi,
+                                                   cell_centered, phat_c, a, facx, facy);
+                    const Real v1 = apply_operator(i, j, 1, ilo, jlo, ihi, jhi,
+                                                   cell_centered, phat_c, a, facx, facy);
+                    v(i,j,0) = v0;
+                    v(i,j,1) = v1;
+                    return {rhat(i,j,0)*v0, rhat(i,j,1)*v1};
+                });
+            auto hv = reduce_data.value(reduce_op);
+            const amrex::GpuArray<Real, m_num_comps> rhatv {amrex::get<0>(hv), amrex::get<1>(hv)};
+            for (int n=0; n<m_num_comps; ++n) {
+                if (converged[n]) {
+                    alpha[n] = 0._rt;
+                } else {
+                    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(rhatv[n] != 0._rt,
+                        "fft_bicgstab: breakdown, (rhat, v) = 0");
+                    alpha[n] = rho[n] / rhatv[n];
+                }
+            }
+        }
+
+        // s = r - alpha * v
+        {
+            const auto alpha_ = alpha;
+            const Array3<Real const> r_c = r;
+            amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_op;
+            amrex::ReduceData<Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(vbx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+                {
+                    const Real s0 = r_c(i,j,0) - alpha_[0] * v(i,j,0);
+                    const Real s1 = r_c(i,j,1) - alpha_[1] * v(i,j,1);
+                    s(i,j,0) = s0;
+                    s(i,j,1) = s1;
+                    return {std::abs(s0), std::abs(s1)};
+                });
+            auto hv = reduce_data.value(reduce_op);
+            resnorm[0] = amrex::get<0>(hv);
+            resnorm[1] = amrex::get<1>(hv);
+        }
+
+        amrex::GpuArray<bool, m_num_comps> s_converged;
+        for (int n=0; n<m_num_comps; ++n) {
+            s_converged[n] = converged[n] || resnorm[n] <= res_target;
+        }
+
+        if (!(s_converged[0] && s_converged[1])) {
+            precondition(m_shat, m_s);
+
+            // t = A(shat), omega = (t, s) / (t, t)
+            const Array3<Real const> shat_c = shat;
+            amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum,
+                             amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+            amrex::ReduceData<Real, Real, Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(vbx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+                {
+                    const Real a = acf(i,j,0);
+                    const Real t0 = apply_operator(i, j, 0, ilo, jlo, ihi, jhi,
+                                                   cell_centered, shat_c, a, facx, facy);
+                    const Real t1 = apply_operator(i, j, 1, ilo, jlo, ihi, jhi,
+                                                   cell_centered, shat_c, a, facx, facy);
+                    t(i,j,0) = t0;
+                    t(i,j,1) = t1;
+                    return {t0*s(i,j,0), t1*s(i,j,1), t0*t0, t1*t1};
+                });
+            auto hv = reduce_data.value(reduce_op);
+            const amrex::GpuArray<Real, m_num_comps> ts {amrex::get<0>(hv), amrex::get<1>(hv)};
+            const amrex::GpuArray<Real, m_num_comps> tt {amrex::get<2>(hv), amrex::get<3>(hv)};
+            for (int n=0; n<m_num_comps; ++n) {
+                omega[n] = (s_converged[n] || tt[n] == 0._rt) ? 0._rt : ts[n] / tt[n];
+            }
+        } else {
+            omega[0] = 0._rt;
+            omega[1] = 0._rt;
+        }
+
+        // sol += alpha * phat + omega * shat, r = s - omega * t
+        {
+            const auto alpha_ = alpha;
+            const auto omega_ = omega;
+            amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax,
+                             amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+            amrex::ReduceData<Real, Real, Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(vbx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+                {
+                    Real r01[m_num_comps];
+                    for (int n=0; n<m_num_comps; ++n) {
+                        sol(i,j,n) += alpha_[n] * phat(i,j,n) + omega_[n] * shat(i,j,n);
+                        r01[n] = s(i,j,n) - omega_[n] * t(i,j,n);
+                        r(i,j,n) = r01[n];
+                    }
+                    return {std::abs(r01[0]), std::abs(r01[1]),
+                            rhat(i,j,0)*r01[0], rhat(i,j,1)*r01[1]};
+                });
+            auto hv = reduce_data.value(reduce_op);
+            resnorm[0] = amrex::get<0>(hv);
+            resnorm[1] = amrex::get<1>(hv);
+            const amrex::GpuArray<Real, m_num_comps> rho_new {amrex::get<2>(hv), amrex::get<3>(hv)};
+            for (int n=0; n<m_num_comps; ++n) {
+                converged[n] = converged[n] || resnorm[n] <= res_target;
+                if (converged[n]) {
+                    beta[n] = 0._rt;
+                } else {
+                    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(omega[n] != 0._rt && rho[n] != 0._rt,
+                        "fft_bicgstab: breakdown, omega = 0 or rho = 0");
+                    beta[n] = (rho_new[n] / rho[n]) * (alpha[n] / omega[n]);
+                }
+                rho[n] = rho_new[n];
+            }
+        }
+
+        const Real norminf = amrex::max(resnorm[0], resnorm[1]);
+        if (verbose >= 2) {
+            amrex::Print() << "fft_bicgstab: Iteration " << std::setw(3) << iter+1 << " resid/"
+                           << norm_name << " = " << norminf/max_norm << "\n";
+        }
+
+        if (converged[0] && converged[1]) {
+            if (verbose >= 1) {
+                amrex::Print() << "fft_bicgstab: Final Iter. " << iter+1
+                               << " resid, resid/" << norm_name << " = "
+                               << norminf << ", " << norminf/max_norm << "\n";
+            }
+            return iter+1;
+        } else if (norminf > Real(1.e20)*max_norm) {
+            if (verbose > 0) {
+                amrex::Print() << "fft_bicgstab: Failing to converge after " << iter+1
+                               << " iterations. resid, resid/" << norm_name << " = "
+                               << norminf << ", " << norminf/max_norm << "\n";
+            }
+            amrex::Abort("fft_bicgstab failing so lets stop here");
+        }
+    }
+
+    if (verbose > 0) {
+        amrex::Print() << "fft_bicgstab: Failed to converge after " << nummaxiter << " iterations."
+                       << " resid, resid/" << norm_name << " = "
+                       << amrex::max(resnorm[0], resnorm[1]) << ", "
+                       << amrex::max(resnorm[0], resnorm[1])/max_norm << "\n";
+    }
+    amrex::Abort("fft_bicgstab failed");
+    return iter;
+}
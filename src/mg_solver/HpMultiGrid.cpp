@@ -8,6 +8,7 @@
 #include "HpMultiGrid.H"
 #include "utils/GPUUtil.H"
 #include <algorithm>
+#include <utility>
 
 using namespace amrex;
 
@@ -1424,6 +1425,83 @@ MultiGrid::solve_doit (FArrayBox& a_sol, FArrayBox const& a_rhs,
     {
         sol(i,j,0,n) = cor(i,j,0,n);
     });
+
+    store_solution();
+}
+
+void
+MultiGrid::set_warm_start (int const order)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(order >= 0 && order <= 2,
+        "hpmg: the order of the warm start must be 0, 1 or 2");
+    m_warm_start_order = order;
+    for (auto& fab : m_history) {
+        if (order > 0 && !fab.isAllocated()) {
+            fab.resize(m_domain[0], m_num_comps);
+        } else if (order == 0) {
+            fab.clear();
+        }
+    }
+    m_history_key = {m_invalid_key, m_invalid_key};
+    m_store_key = m_invalid_key;
+}
+
+void
+MultiGrid::warm_start (FArrayBox& a_sol, int const key)
+{
+    if (m_warm_start_order == 0) return;
+    HIPACE_PROFILE("hpmg::MultiGrid::warm_start()");
+
+    m_store_key = key;
+
+    int num_prev = 0;
+    if (m_history_key[0] == key) {
+        // same slice solved again, its solution is the best guess
+        num_prev = 1;
+    } else if (m_history_key[0] == key+1 || m_history_key[0] == key+2) {
+        num_prev = (m_warm_start_order == 2 && m_history_key[0] == key+1 &&
+                    m_history_key[1] == key+2) ? 2 : 1;
+    }
+    if (num_prev == 0) return;
+
+    FArrayBox solfab(center_box(a_sol.box(), m_domain.front()), m_num_comps, a_sol.dataPtr());
+    auto const& sol = solfab.array();
+    auto const& prev1 = m_history[0].const_array();
+    auto const& prev2 = m_history[1].const_array();
+    if (num_prev == 1) {
+        hpmg::ParallelFor(to2D(valid_domain_box(m_domain[0])), m_num_comps,
+        [=] AMREX_GPU_DEVICE (int i, int j, int n) noexcept
+        {
+            sol(i,j,0,n) = prev1(i,j,0,n);
+        });
+    } else {
+        hpmg::ParallelFor(to2D(valid_domain_box(m_domain[0])), m_num_comps,
+        [=] AMREX_GPU_DEVICE (int i, int j, int n) noexcept
+        {
+            sol(i,j,0,n) = Real(2.)*prev1(i,j,0,n) - prev2(i,j,0,n);
+        });
+    }
+}
+
+void
+MultiGrid::store_solution ()
+{
+    if (m_store_key == m_invalid_key) return;
+
+    if (m_history_key[0] != m_store_key) {
+        std::swap(m_history[0], m_history[1]);
+        m_history_key[1] = m_history_key[0];
+    }
+    m_history_key[0] = m_store_key;
+    m_store_key = m_invalid_key;
+
+    auto const& sol = m_sol.const_array();
+    auto const& hist = m_history[0].array();
+    hpmg::ParallelFor(to2D(valid_domain_box(m_domain[0])), m_num_comps,
+    [=] AMREX_GPU_DEVICE (int i, int j, int n) noexcept
+    {
+        hist(i,j,0,n) = sol(i,j,0,n);
+    });
 }
 
 void
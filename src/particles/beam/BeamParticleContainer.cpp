@@ -12,6 +12,7 @@
 #include "Hipace.H"
 #include "utils/HipaceProfilerWrapper.H"
 #include "utils/InsituUtil.H"
+#include "utils/OMPUtil.H"
 #ifdef HIPACE_USE_OPENPMD
 #   include <openPMD/auxiliary/Filesystem.hpp>
 #endif
@@ -63,6 +64,17 @@ BeamParticleContainer::ReadParameters ()
     queryWithParserAlt(pp, "insitu_radius", m_insitu_radius, pp_alt);
     queryWithParser(pp, "n_subcycles", m_n_subcycles);
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE( m_n_subcycles >= 1, "n_subcycles must be >= 1");
+    queryWithParserAlt(pp, "adaptive_subcycling", m_adaptive_subcycling, pp_alt);
+    queryWithParserAlt(pp, "adaptive_subcycling_tolerance", m_adaptive_subcycling_tolerance,
+                       pp_alt);
+    m_adaptive_subcycling_max_merge = m_n_subcycles;
+    queryWithParserAlt(pp, "adaptive_subcycling_max_merge", m_adaptive_subcycling_max_merge,
+                       pp_alt);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_adaptive_subcycling_max_merge >= 1,
+        "adaptive_subcycling_max_merge must be >= 1");
+    if (m_adaptive_subcycling) {
+        m_subcycle_counters.resize(2, 0);
+    }
     queryWithParser(pp, "do_salame", m_do_salame);
     queryWithParserAlt(pp, "reorder_period", m_reorder_period, pp_alt);
     amrex::Array<int, 2> idx_array
@@ -175,6 +187,10 @@ BeamParticleContainer::InitData (const amrex::Geometry& geom)
         queryWithParser(pp, "do_symmetrize", m_do_symmetrize);
         if (m_do_symmetrize) AMREX_ALWAYS_ASSERT_WITH_MESSAGE( m_num_particles%4 == 0,
             "To symmetrize the beam, please specify a beam particle number divisible by 4.");
+        queryWithParser(pp, "lazy_generation", m_lazy_generation);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_lazy_generation || m_can_profile ||
+            m_position_std[2] > 0.,
+            "beam.lazy_generation requires a positive position_std in z for a gaussian profile");
 
         if (peak_density_is_specified)
         {
@@ -192,7 +208,7 @@ BeamParticleContainer::InitData (const amrex::Geometry& geom)
         m_get_momentum = GetInitialMomentum{m_name};
         InitBeamFixedWeight3D();
         m_total_num_particles = m_num_particles;
-        if (Hipace::HeadRank()) {
+        if (Hipace::HeadRank() && !m_lazy_generation) {
             m_init_sorter.sortParticlesByBox(m_z_array.dataPtr(), m_z_array.size(),
                                              m_initialize_on_cpu, geom);
         }
@@ -256,6 +272,9 @@ BeamParticleContainer::InitData (const amrex::Geometry& geom)
                                                         m_file_coordinates_xyz, pp_alt);
         queryWithParserAlt(pp, "plasma_density", m_plasma_density, pp_alt);
         queryWithParserAlt(pp, "iteration", m_num_iteration, pp_alt);
+        queryWithParserAlt(pp, "file_chunk_size", m_file_chunk_size, pp_alt);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_file_chunk_size > 0,
+            "beam.file_chunk_size must be positive");
         bool species_specified = queryWithParser(pp, "openPMD_species_name", m_species_name);
         if(!species_specified) {
             m_species_name = m_name;
@@ -305,9 +324,11 @@ BeamParticleContainer::InitData (const amrex::Geometry& geom)
         m_insitu_idata.resize(m_nslices*m_insitu_nip, 0);
         m_insitu_sum_rdata.resize(m_insitu_nrp, 0.);
         m_insitu_sum_idata.resize(m_insitu_nip, 0);
+        m_insitu_acc.resize(m_nslices);
         if (m_do_spin_tracking) {
             m_insitu_spin_data.resize(m_nslices*m_insitu_n_spin, 0.);
             m_insitu_sum_spin_data.resize(m_insitu_n_spin, 0.);
+            m_insitu_spin_acc.resize(m_nslices);
         }
     }
 
@@ -320,8 +341,8 @@ void BeamParticleContainer::TagByLevel (const int current_N_level,
     HIPACE_PROFILE("BeamParticleContainer::TagByLevel()");
 
     auto& soa = getBeamSlice(which_slice).GetStructOfArrays();
-    const amrex::Real * const pos_x = soa.GetRealData(BeamIdx::x).data();
-    const amrex::Real * const pos_y = soa.GetRealData(BeamIdx::y).data();
+    const amrex::ParticleReal * const pos_x = soa.GetRealData(BeamIdx::x).data();
+    const amrex::ParticleReal * const pos_y = soa.GetRealData(BeamIdx::y).data();
     int * const p_mr_level = soa.GetIntData(BeamIdx::mr_level).data();
 
     const int lev1_idx = std::min(1, current_N_level-1);
@@ -330,7 +351,7 @@ void BeamParticleContainer::TagByLevel (const int current_N_level,
     const CheckDomainBounds lev1_bounds {geom3D[lev1_idx]};
     const CheckDomainBounds lev2_bounds {geom3D[lev2_idx]};
 
-    amrex::ParallelFor(getNumParticlesIncludingSlipped(which_slice),
+    omp::ParallelFor(getNumParticlesIncludingSlipped(which_slice),
         [=] AMREX_GPU_DEVICE (int ip) {
             const amrex::Real xp = pos_x[ip];
             const amrex::Real yp = pos_y[ip];
@@ -369,7 +390,7 @@ BeamParticleContainer::initializeSlice (int slice, int which_slice) {
         const int slice_offset = m_init_sorter.m_box_offsets_cpu[slice];
         const auto permutations = m_init_sorter.m_box_permutations.dataPtr();
 
-        amrex::ParallelFor(num_particles,
+        omp::ParallelFor(num_particles,
             [=] AMREX_GPU_DEVICE (const int ip) {
                 const int idx_src = permutations[slice_offset + ip];
                 ptd.rdata(BeamIdx::x)[ip] = ptd_init.rdata(BeamIdx::x)[idx_src];
@@ -393,7 +414,7 @@ BeamParticleContainer::initializeSlice (int slice, int which_slice) {
 
         const amrex::RealVect initial_spin_norm = m_initial_spin / m_initial_spin.vectorLength();
 
-        amrex::ParallelFor(getNumParticles(which_slice),
+        omp::ParallelFor(getNumParticles(which_slice),
             [=] AMREX_GPU_DEVICE (const int ip) {
                 ptd.m_runtime_rdata[0][ip] = initial_spin_norm[0];
                 ptd.m_runtime_rdata[1][ip] = initial_spin_norm[1];
@@ -433,7 +454,7 @@ BeamParticleContainer::ReorderParticles (int beam_slice, int step, amrex::Geomet
 
             auto src = soa.GetIdCPUData().data();
             uint64_t* dst = tmp_idcpu.data();
-            amrex::ParallelFor(np_total,
+            omp::ParallelFor(np_total,
                 [=] AMREX_GPU_DEVICE (int i) {
                     dst[i] = i < np ? src[permutations[i]] : src[i];
                 });
@@ -447,7 +468,7 @@ BeamParticleContainer::ReorderParticles (int beam_slice, int step, amrex::Geomet
             for (int comp = 0; comp < soa.NumRealComps(); ++comp) {
                 auto src = soa.GetRealData(comp).data();
                 amrex::ParticleReal* dst = tmp_real.data();
-                amrex::ParallelFor(np_total,
+                omp::ParallelFor(np_total,
                     [=] AMREX_GPU_DEVICE (int i) {
                         dst[i] = i < np ? src[permutations[i]] : src[i];
                     });
@@ -461,7 +482,7 @@ BeamParticleContainer::ReorderParticles (int beam_slice, int step, amrex::Geomet
         for (int comp = 0; comp < soa.NumIntComps(); ++comp) {
             auto src = soa.GetIntData(comp).data();
             int* dst = tmp_int.data();
-            amrex::ParallelFor(np_total,
+            omp::ParallelFor(np_total,
                 [=] AMREX_GPU_DEVICE (int i) {
                     dst[i] = i < np ? src[permutations[i]] : src[i];
                 });
@@ -479,20 +500,16 @@ BeamParticleContainer::InSituComputeDiags (int islice)
 
     using namespace amrex::literals;
 
-    AMREX_ALWAYS_ASSERT(m_insitu_rdata.size()>0 && m_insitu_idata.size()>0 &&
-                        m_insitu_sum_rdata.size()>0 && m_insitu_sum_idata.size()>0);
+    AMREX_ALWAYS_ASSERT(!m_insitu_acc.empty());
 
     const amrex::Real insitu_radius_sq = m_insitu_radius * m_insitu_radius;
     const PhysConst phys_const = get_phys_const();
     const amrex::Real clight_inv = 1.0_rt/phys_const.c;
     const auto ptd = getBeamSlice(WhichBeamSlice::This).getParticleTileData();
 
-    amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpSum[m_insitu_nrp + m_insitu_nip]> reduce_op;
-    amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[m_insitu_nrp], int[m_insitu_nip]> reduce_data(reduce_op);
-    using ReduceTuple = typename decltype(reduce_data)::Type;
-    reduce_op.eval(
-        getNumParticles(WhichBeamSlice::This), reduce_data,
-        [=] AMREX_GPU_DEVICE (int ip) -> ReduceTuple
+    // the results stay on the device until InSituWriteToFile, so there is no synchronization here
+    m_insitu_acc.Reduce(islice, getNumParticles(WhichBeamSlice::This),
+        [=] AMREX_GPU_DEVICE (int ip) -> amrex::GpuArray<amrex::Real, m_insitu_nrp + m_insitu_nip>
         {
             const amrex::Real x = ptd.pos(0, ip);
             const amrex::Real y = ptd.pos(1, ip);
@@ -505,10 +522,10 @@ BeamParticleContainer::InSituComputeDiags (int islice)
             const amrex::Real uz_inv = uz == 0._rt ? 0._rt : 1._rt / uz;
 
             if (!ptd.id(ip).is_valid() || x*x + y*y > insitu_radius_sq) {
-                return amrex::IdentityTuple(ReduceTuple{}, reduce_op);
+                return {};
             }
             const amrex::Real gamma = std::sqrt(1.0_rt + ux*ux + uy*uy + uz*uz);
-            return {            // Tuple contains:
+            return {            // Array contains:
                 w,              // 0    sum(w)
                 w*x,            // 1    [x]
                 w*x*x,          // 2    [x^2]
@@ -531,37 +548,13 @@ BeamParticleContainer::InSituComputeDiags (int islice)
                 w*uy*uz_inv,    // 19   [uy/uz]
                 w*gamma,        // 20   [ga]
                 w*gamma*gamma,  // 21   [ga^2]
-                1               // 22   Np
+                1._rt           // 22   Np
             };
         });
 
-    auto [real_tup, int_tup] = amrex::TupleSplit<m_insitu_nrp, m_insitu_nip>(reduce_data.value());
-
-    auto real_arr = amrex::tupleToArray(real_tup);
-
-    const amrex::Real sum_w_inv = real_arr[0] <= 0._rt ? 0._rt : 1._rt / real_arr[0];
-
-    for (int i=0; i<m_insitu_nrp; ++i) {
-        m_insitu_rdata[islice + i * m_nslices] = real_arr[i] *
-            // sum(w) is not multiplied by sum_w_inv
-            ( i == 0 ? 1 : sum_w_inv );
-        m_insitu_sum_rdata[i] += real_arr[i];
-    }
-
-    auto int_arr = amrex::tupleToArray(int_tup);
-
-    for (int i=0; i<m_insitu_nip; ++i) {
-        m_insitu_idata[islice + i * m_nslices] = int_arr[i];
-        m_insitu_sum_idata[i] += int_arr[i];
-    }
-
     if (m_do_spin_tracking) {
-        amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpSum[m_insitu_n_spin]> reduce_op_spin;
-        amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[m_insitu_n_spin]> reduce_data_spin(reduce_op_spin);
-        using ReduceTupleSpin = typename decltype(reduce_data_spin)::Type;
-        reduce_op_spin.eval(
-            getNumParticles(WhichBeamSlice::This), reduce_data_spin,
-            [=] AMREX_GPU_DEVICE (int ip) -> ReduceTupleSpin
+        m_insitu_spin_acc.Reduce(islice, getNumParticles(WhichBeamSlice::This),
+            [=] AMREX_GPU_DEVICE (int ip) -> amrex::GpuArray<amrex::Real, m_insitu_n_spin>
             {
                 const amrex::Real x = ptd.pos(0, ip);
                 const amrex::Real y = ptd.pos(1, ip);
@@ -571,9 +564,9 @@ BeamParticleContainer::InSituComputeDiags (int islice)
                 const amrex::Real w = ptd.rdata(BeamIdx::w)[ip];
 
                 if (!ptd.id(ip).is_valid() || x*x + y*y > insitu_radius_sq) {
-                    return amrex::IdentityTuple(ReduceTupleSpin{}, reduce_op_spin);
+                    return {};
                 }
-                return {            // Tuple contains:
+                return {            // Array contains:
                     w*sx,           // 0    [sx]
                     w*sx*sx,        // 1    [sx^2]
                     w*sy,           // 2    [sy]
@@ -582,12 +575,42 @@ BeamParticleContainer::InSituComputeDiags (int islice)
                     w*sz*sz,        // 5    [sz^2]
                 };
             });
+    }
+}
 
-        auto spin_arr = amrex::tupleToArray(reduce_data_spin.value());
+void
+BeamParticleContainer::InSituCopyToHost ()
+{
+    // get the data of all slices from the device
+    m_insitu_acc.CopyToHost();
+    if (m_do_spin_tracking) {
+        m_insitu_spin_acc.CopyToHost();
+    }
+
+    for (int islice=0; islice<m_nslices; ++islice) {
+        const double sum_w = m_insitu_acc.get(islice, 0);
+        const double sum_w_inv = sum_w <= 0. ? 0. : 1. / sum_w;
+
+        for (int i=0; i<m_insitu_nrp; ++i) {
+            const double val = m_insitu_acc.get(islice, i);
+            m_insitu_rdata[islice + i * m_nslices] = static_cast<amrex::Real>(
+                // sum(w) is not multiplied by sum_w_inv
+                val * ( i == 0 ? 1. : sum_w_inv ));
+            m_insitu_sum_rdata[i] += static_cast<amrex::Real>(val);
+        }
+
+        for (int i=0; i<m_insitu_nip; ++i) {
+            const int val = static_cast<int>(m_insitu_acc.get(islice, m_insitu_nrp + i));
+            m_insitu_idata[islice + i * m_nslices] = val;
+            m_insitu_sum_idata[i] += val;
+        }
 
-        for (int i=0; i<m_insitu_n_spin; ++i) {
-            m_insitu_spin_data[islice + i * m_nslices] = spin_arr[i] * sum_w_inv;
-            m_insitu_sum_spin_data[i] += spin_arr[i];
+        if (m_do_spin_tracking) {
+            for (int i=0; i<m_insitu_n_spin; ++i) {
+                const double val = m_insitu_spin_acc.get(islice, i);
+                m_insitu_spin_data[islice + i * m_nslices] = static_cast<amrex::Real>(val * sum_w_inv);
+                m_insitu_sum_spin_data[i] += static_cast<amrex::Real>(val);
+            }
         }
     }
 }
@@ -611,6 +634,8 @@ BeamParticleContainer::InSituWriteToFile (int step, amrex::Real time, const amre
     std::ofstream ofs{m_insitu_file_prefix + "/reduced_" + m_name + "." + pad_rank_num + ".txt",
         std::ofstream::out | std::ofstream::app | std::ofstream::binary};
 
+    InSituCopyToHost();
+
     const amrex::Real sum_w0 = m_insitu_sum_rdata[0];
     const std::size_t nslices = static_cast<std::size_t>(m_nslices);
     const amrex::Real normalized_density_factor = Hipace::m_normalized_units ?
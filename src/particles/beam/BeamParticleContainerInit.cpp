@@ -13,9 +13,12 @@
 #include "Hipace.H"
 #include "utils/HipaceProfilerWrapper.H"
 #include <AMReX_REAL.H>
+#include <algorithm>
+#include <cmath>
 
 #ifdef HIPACE_USE_OPENPMD
 #include <openPMD/openPMD.hpp>
+#include <array>
 #include <iostream> // std::cout
 #include <memory>   // std::shared_ptr
 #endif  // HIPACE_USE_OPENPMD
@@ -114,6 +117,81 @@ namespace
             ptd.id(ip).make_invalid();
         }
     }
+
+    /** \brief Sample a position inside [zmin, zmin+dz] from a density that changes linearly
+     * from lo_weight at zmin to hi_weight at zmin+dz
+     *
+     * \param[in] zmin lower end of the interval
+     * \param[in] dz length of the interval
+     * \param[in] lo_weight density at zmin
+     * \param[in] hi_weight density at zmin+dz
+     * \param[in] use_taylor use a Taylor expansion if lo_weight and hi_weight are similar
+     * \param[in] lo_hi_weight_inv 1/(hi_weight+lo_weight) if use_taylor else 1/(hi_weight-lo_weight)
+     * \param[in] w random number in [0, 1)
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    amrex::Real SampleLinearDensity (const amrex::Real zmin, const amrex::Real dz,
+                                     const amrex::Real lo_weight, const amrex::Real hi_weight,
+                                     const bool use_taylor, const amrex::Real lo_hi_weight_inv,
+                                     const amrex::Real w) noexcept
+    {
+        using namespace amrex::literals;
+        if (use_taylor) {
+            return zmin + dz*(w - w*(w-1._rt)*(hi_weight-lo_weight)*lo_hi_weight_inv);
+        } else {
+            return zmin + dz*((std::sqrt(lo_weight*lo_weight
+                +w*(hi_weight*hi_weight-lo_weight*lo_weight))-lo_weight)*lo_hi_weight_inv);
+        }
+    }
+
+    /** \brief Distribute num_to_add particles over bins proportional to their weight,
+     * mimicking how many independent particles would end up in every bin
+     *
+     * \param[out] num_particles_bin number of particles in every bin
+     * \param[in] weight weight of every bin, must be >= 0
+     * \param[in] num_to_add total number of particles
+     */
+    void DistributeParticles (amrex::Vector<unsigned int>& num_particles_bin,
+                              const amrex::Vector<amrex::Real>& weight, const amrex::Long num_to_add)
+    {
+        const int nbins = weight.size();
+        num_particles_bin.assign(nbins, 0);
+
+        amrex::Real integral = 0.;
+        for (int bin=nbins-1; bin>=0; --bin) {
+            integral += weight[bin];
+        }
+
+        amrex::Long num_added = 0;
+
+        while (num_added != num_to_add) {
+
+            // It is very unlikely that the correct amount of particles will be initialized in the first
+            // iteration. Another iteration is done with remaining particles (or subtracting extra
+            // particles). This converges quickly as the expected deviation is sqrt(num_to_add_now),
+            // resulting in a time complexity of O(num_slices*log(log(num_to_add)))
+            const amrex::Long num_to_add_now = num_to_add - num_added;
+
+            for (int bin=nbins-1; bin>=0; --bin) {
+                const amrex::Real mean_particles = num_to_add_now*weight[bin]/integral;
+
+                if (mean_particles >= 0) {
+                    // use a Poisson distribution to mimic how many independent particles would be
+                    // initialized according to the full PDF
+                    const unsigned int n = amrex::RandomPoisson(mean_particles);
+                    num_particles_bin[bin] += n;
+                    num_added += n;
+                } else {
+                    // if there were too many particles initialized in an earlier iteration we need to
+                    // remove some but also avoid having less than zero particles per slice
+                    const unsigned int n = std::min(amrex::RandomPoisson(-mean_particles),
+                                                    num_particles_bin[bin]);
+                    num_particles_bin[bin] -= n;
+                    num_added -= n;
+                }
+            }
+        }
+    }
 }
 
 void
@@ -357,9 +435,41 @@ InitBeamFixedWeight3D ()
     amrex::Long num_to_add = m_num_particles;
     if (m_do_symmetrize) num_to_add /= 4;
 
+    if (m_lazy_generation) {
+        // Only compute how many particles are in every slice. The particles are generated
+        // in InitBeamFixedWeightSlice, so their z positions never have to be stored or sorted.
+        const amrex::Geometry& geom = Hipace::GetInstance().m_3D_geom[0];
+        const int nslices = geom.Domain().length(2);
+        const amrex::Real dz = geom.CellSize(2);
+        const amrex::Real plo_z = geom.ProbLo(2);
+
+        // cumulative distribution function of the z positions
+        auto cdf = [&] (amrex::Real z) -> amrex::Real {
+            if (m_can_profile) {
+                return std::clamp((z - m_zmin) / (m_zmax - m_zmin), 0._rt, 1._rt);
+            } else {
+                return 0.5_rt * std::erfc(-(z - m_pos_mean_z) /
+                                          (std::sqrt(2._rt) * m_position_std[2]));
+            }
+        };
+
+        // the last bin contains the particles outside of the domain, they are not initialized
+        amrex::Vector<amrex::Real> slice_weight(nslices + 1);
+        amrex::Real weight_inside = 0._rt;
+        for (int slice=nslices-1; slice>=0; --slice) {
+            slice_weight[slice] = std::max(
+                cdf(plo_z + (slice+1)*dz) - cdf(plo_z + slice*dz), 0._rt);
+            weight_inside += slice_weight[slice];
+        }
+        slice_weight[nslices] = std::max(1._rt - weight_inside, 0._rt);
+
+        DistributeParticles(m_num_particles_slice, slice_weight, num_to_add);
+        return;
+    }
+
     m_z_array.setArena(m_initialize_on_cpu ? amrex::The_Pinned_Arena() : amrex::The_Arena());
     m_z_array.resize(num_to_add);
-    amrex::Real * const pos_z = m_z_array.dataPtr();
+    amrex::ParticleReal * const pos_z = m_z_array.dataPtr();
 
     const bool can = m_can_profile;
     const amrex::Real z_min = m_zmin;
@@ -388,7 +498,8 @@ InitBeamFixedWeightSlice (int slice, int which_slice)
 
     if (!Hipace::HeadRank() || m_num_particles == 0) { return; }
 
-    const int num_to_add = m_init_sorter.m_box_counts_cpu[slice];
+    const int num_to_add = m_lazy_generation ? m_num_particles_slice[slice]
+                                              : m_init_sorter.m_box_counts_cpu[slice];
     if (m_do_symmetrize) {
         resize(which_slice, 4*num_to_add, 0);
     } else {
@@ -404,9 +515,10 @@ InitBeamFixedWeightSlice (int slice, int which_slice)
     // Access particles' SoA
     const auto ptd = particle_tile.getParticleTileData();
 
-    const amrex::Long slice_offset = m_init_sorter.m_box_offsets_cpu[slice];
-    const auto permutations = m_init_sorter.m_box_permutations.dataPtr();
-    amrex::Real * const pos_z = m_z_array.dataPtr();
+    const bool lazy = m_lazy_generation;
+    const amrex::Long slice_offset = lazy ? 0 : m_init_sorter.m_box_offsets_cpu[slice];
+    const auto permutations = lazy ? nullptr : m_init_sorter.m_box_permutations.dataPtr();
+    amrex::ParticleReal * const pos_z = m_z_array.dataPtr();
 
     const uint64_t pid = m_id64;
     m_id64 += m_do_symmetrize ? 4*num_to_add : num_to_add;
@@ -426,11 +538,35 @@ InitBeamFixedWeightSlice (int slice, int which_slice)
     const GetInitialMomentum get_momentum = m_get_momentum;
     const auto enforceBC = EnforceBC();
 
+    // with lazy generation, z is sampled inside the slice. This is exact for the can profile,
+    // for the gaussian profile the density is approximated as linear inside the slice.
+    const amrex::Geometry& geom = Hipace::GetInstance().m_3D_geom[0];
+    const amrex::Real slice_lo = geom.ProbLo(2) + slice*geom.CellSize(2);
+    const amrex::Real slice_hi = geom.ProbLo(2) + (slice+1)*geom.CellSize(2);
+    const amrex::Real can_lo = std::max(slice_lo, z_min);
+    const amrex::Real can_hi = std::min(slice_hi, z_max);
+    auto gaussian = [&] (amrex::Real z) {
+        return std::exp(-0.5_rt*(z - z_mean)*(z - z_mean)/(pos_std[2]*pos_std[2]));
+    };
+    const amrex::Real lo_weight = can ? 1._rt : gaussian(slice_lo);
+    const amrex::Real hi_weight = can ? 1._rt : gaussian(slice_hi);
+    const bool use_taylor = std::min(lo_weight, hi_weight)*1.1 >= std::max(lo_weight, hi_weight);
+    const amrex::Real lo_hi_weight_inv = use_taylor ?
+        1._rt/(hi_weight+lo_weight) : 1._rt/(hi_weight-lo_weight);
+
     amrex::ParallelForRNG(
         num_to_add,
         [=] AMREX_GPU_DEVICE (amrex::Long i, const amrex::RandomEngine& engine) noexcept
         {
-            const amrex::Real z_central = pos_z[permutations[slice_offset + i]];
+            amrex::Real z_central = 0._rt;
+            if (!lazy) {
+                z_central = pos_z[permutations[slice_offset + i]];
+            } else if (can) {
+                z_central = can_lo + amrex::Random(engine) * (can_hi - can_lo);
+            } else {
+                z_central = SampleLinearDensity(slice_lo, slice_hi - slice_lo, lo_weight,
+                    hi_weight, use_taylor, lo_hi_weight_inv, amrex::Random(engine));
+            }
             amrex::Real x = amrex::RandomNormal(0, pos_std[0], engine);
             amrex::Real y = amrex::RandomNormal(0, pos_std[1], engine);
 
@@ -489,8 +625,6 @@ InitBeamFixedWeightPDF3D ()
     const amrex::Geometry geom = Hipace::GetInstance().m_3D_geom[0];
     const amrex::Box domain = geom.Domain();
 
-    m_num_particles_slice.resize(domain.length(2) * m_pdf_ref_ratio);
-
     const amrex::Real zoffset = geom.ProbLo(2);
     const amrex::Real zscale = geom.CellSize(2) / m_pdf_ref_ratio;
 
@@ -498,6 +632,7 @@ InitBeamFixedWeightPDF3D ()
     amrex::Real max_density = 0._rt;
     amrex::Real avg_uz = 0._rt;
     amrex::Real avg_uz_sq = 0._rt;
+    amrex::Vector<amrex::Real> slice_weight(domain.length(2) * m_pdf_ref_ratio);
 
     for (int slice=domain.length(2)*m_pdf_ref_ratio-1; slice>=0; --slice) {
         const amrex::Real zmin = zoffset + slice*zscale;
@@ -524,7 +659,7 @@ InitBeamFixedWeightPDF3D ()
         avg_uz_sq += local_weight * (uz_mean_local*uz_mean_local + uz_std_local*uz_std_local);
 
         integral += local_weight;
-        m_num_particles_slice[slice] = 0;
+        slice_weight[slice] = local_weight;
     }
 
     if (m_peak_density_is_specified) {
@@ -541,42 +676,7 @@ InitBeamFixedWeightPDF3D ()
         m_total_weight *= geom.InvCellSize(0)*geom.InvCellSize(1)*geom.InvCellSize(2);
     }
 
-    amrex::Long num_added = 0;
-
-    while (num_added != num_to_add) {
-
-        // It is very unlikely that the correct amount of particles will be initialized in the first
-        // iteration. Another iteration is done with remaining particles (or subtracting extra
-        // particles). This converges quickly as the expected deviation is sqrt(num_to_add_now),
-        // resulting in a time complexity of O(num_slices*log(log(num_to_add)))
-        const amrex::Long num_to_add_now = num_to_add - num_added;
-
-        for (int slice=domain.length(2)*m_pdf_ref_ratio-1; slice >=0; --slice) {
-            const amrex::Real zmin = zoffset + slice*zscale;
-            const amrex::Real zmax = zoffset + (slice+1)*zscale;
-
-            const amrex::Real pdf_zmin = m_pdf_func(zmin);
-            const amrex::Real pdf_zmax = m_pdf_func(zmax);
-            const amrex::Real local_weight = 0.5_rt*(pdf_zmin+pdf_zmax);
-
-            const amrex::Real mean_particles = num_to_add_now*local_weight/integral;
-
-            if (mean_particles >= 0) {
-                // use a Poisson distribution to mimic how many independent particles would be
-                // initialized according to the full PDF
-                const unsigned int n = amrex::RandomPoisson(mean_particles);
-                m_num_particles_slice[slice] += n;
-                num_added += n;
-            } else {
-                // if there were too many particles initialized in an earlier iteration we need to
-                // remove some but also avoid having less than zero particles per slice
-                const unsigned int n = std::min(amrex::RandomPoisson(-mean_particles),
-                                                m_num_particles_slice[slice]);
-                m_num_particles_slice[slice] -= n;
-                num_added -= n;
-            }
-        }
-    }
+    DistributeParticles(m_num_particles_slice, slice_weight, num_to_add);
 }
 
 void
@@ -643,13 +743,8 @@ InitBeamFixedWeightPDFSlice (int slice, int which_slice)
                 i += loc_index;
 
                 const amrex::Real w = amrex::Random(engine);
-                amrex::Real z = zmin;
-                if (use_taylor) {
-                    z += dz*(w - w*(w-1._rt)*(hi_weight-lo_weight)*lo_hi_weight_inv);
-                } else {
-                    z += dz*((std::sqrt(lo_weight*lo_weight
-                        +w*(hi_weight*hi_weight-lo_weight*lo_weight))-lo_weight)*lo_hi_weight_inv);
-                }
+                const amrex::Real z = SampleLinearDensity(zmin, dz, lo_weight, hi_weight,
+                                                          use_taylor, lo_hi_weight_inv, w);
 
                 const amrex::Real x_mean = pos_func[0](z);
                 const amrex::Real y_mean = pos_func[1](z);
@@ -972,34 +1067,6 @@ InitBeamFromFile (const std::string input_file,
         amrex::Abort("Beam from file can't have more than 2'147'483'646 Particles\n");
     }
 
-    auto del = [](input_type *p){ amrex::The_Pinned_Arena()->free(reinterpret_cast<void*>(p)); };
-
-    // copy Data to pinned memory
-    std::shared_ptr<input_type> r_x_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> r_y_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> r_z_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> u_x_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> u_y_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> u_z_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-    std::shared_ptr<input_type> w_w_data{ reinterpret_cast<input_type*>(
-        amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*num_to_add) ), del};
-
-    electrons[name_r][name_rx].loadChunk<input_type>(r_x_data, {0u}, {num_to_add});
-    electrons[name_r][name_ry].loadChunk<input_type>(r_y_data, {0u}, {num_to_add});
-    electrons[name_r][name_rz].loadChunk<input_type>(r_z_data, {0u}, {num_to_add});
-    electrons[name_u][name_ux].loadChunk<input_type>(u_x_data, {0u}, {num_to_add});
-    electrons[name_u][name_uy].loadChunk<input_type>(u_y_data, {0u}, {num_to_add});
-    electrons[name_u][name_uz].loadChunk<input_type>(u_z_data, {0u}, {num_to_add});
-    electrons[name_w][name_ww].loadChunk<input_type>(w_w_data, {0u}, {num_to_add});
-
-    series.flush();
-
     // calculate the multiplier to convert to Hipace units
     if(Hipace::m_normalized_units) {
         if(n_0 == 0) {
@@ -1058,28 +1125,71 @@ InitBeamFromFile (const std::string input_file,
     const uint64_t pid = m_id64;
     m_id64 += num_to_add;
 
-    const input_type * const r_x_ptr = r_x_data.get();
-    const input_type * const r_y_ptr = r_y_data.get();
-    const input_type * const r_z_ptr = r_z_data.get();
-    const input_type * const u_x_ptr = u_x_data.get();
-    const input_type * const u_y_ptr = u_y_data.get();
-    const input_type * const u_z_ptr = u_z_data.get();
-    const input_type * const w_w_ptr = w_w_data.get();
-
-    amrex::ParallelFor(amrex::Long(num_to_add),
-        [=] AMREX_GPU_DEVICE (const amrex::Long i) {
-            AddOneBeamParticle(ptd,
-                static_cast<amrex::Real>(r_x_ptr[i] * unit_rx),
-                static_cast<amrex::Real>(r_y_ptr[i] * unit_ry),
-                static_cast<amrex::Real>(r_z_ptr[i] * unit_rz),
-                static_cast<amrex::Real>(u_x_ptr[i] * unit_ux), // = gamma * beta
-                static_cast<amrex::Real>(u_y_ptr[i] * unit_uy),
-                static_cast<amrex::Real>(u_z_ptr[i] * unit_uz),
-                static_cast<amrex::Real>(w_w_ptr[i] * unit_ww),
-                pid, i, phys_const.c, enforceBC);
-        });
+    // Read the file in chunks of at most m_file_chunk_size particles into two pinned buffers.
+    // The next chunk is read from the file while the previous one is converted on the device,
+    // and only two chunks instead of the whole beam have to fit into pinned memory.
+    const uint64_t chunk_size = std::max<uint64_t>(
+        std::min<uint64_t>(num_to_add, static_cast<uint64_t>(m_file_chunk_size)), 1u);
 
-    amrex::Gpu::streamSynchronize();
+    std::array<openPMD::RecordComponent, 7> record_comps {
+        electrons[name_r][name_rx], electrons[name_r][name_ry], electrons[name_r][name_rz],
+        electrons[name_u][name_ux], electrons[name_u][name_uy], electrons[name_u][name_uz],
+        electrons[name_w][name_ww]
+    };
+
+    auto del = [](input_type *p){ amrex::The_Pinned_Arena()->free(reinterpret_cast<void*>(p)); };
+
+    std::array<std::array<std::shared_ptr<input_type>, 7>, 2> pinned_data;
+    for (auto& buffer : pinned_data) {
+        for (auto& comp : buffer) {
+            comp = std::shared_ptr<input_type>{ reinterpret_cast<input_type*>(
+                amrex::The_Pinned_Arena()->alloc(sizeof(input_type)*chunk_size) ), del};
+        }
+    }
+
+    auto load_chunk = [&] (int ibuf, uint64_t offset) {
+        const uint64_t n = std::min(chunk_size, num_to_add - offset);
+        for (int comp=0; comp<7; ++comp) {
+            record_comps[comp].loadChunk<input_type>(pinned_data[ibuf][comp], {offset}, {n});
+        }
+        series.flush();
+    };
+
+    if (num_to_add > 0) load_chunk(0, 0);
+
+    int ibuf = 0;
+    for (uint64_t offset = 0; offset < num_to_add; offset += chunk_size) {
+        const amrex::Long n = static_cast<amrex::Long>(std::min(chunk_size, num_to_add - offset));
+        const amrex::Long ip_offset = static_cast<amrex::Long>(offset);
+
+        const input_type * const r_x_ptr = pinned_data[ibuf][0].get();
+        const input_type * const r_y_ptr = pinned_data[ibuf][1].get();
+        const input_type * const r_z_ptr = pinned_data[ibuf][2].get();
+        const input_type * const u_x_ptr = pinned_data[ibuf][3].get();
+        const input_type * const u_y_ptr = pinned_data[ibuf][4].get();
+        const input_type * const u_z_ptr = pinned_data[ibuf][5].get();
+        const input_type * const w_w_ptr = pinned_data[ibuf][6].get();
+
+        amrex::ParallelFor(n,
+            [=] AMREX_GPU_DEVICE (const amrex::Long i) {
+                AddOneBeamParticle(ptd,
+                    static_cast<amrex::Real>(r_x_ptr[i] * unit_rx),
+                    static_cast<amrex::Real>(r_y_ptr[i] * unit_ry),
+                    static_cast<amrex::Real>(r_z_ptr[i] * unit_rz),
+                    static_cast<amrex::Real>(u_x_ptr[i] * unit_ux), // = gamma * beta
+                    static_cast<amrex::Real>(u_y_ptr[i] * unit_uy),
+                    static_cast<amrex::Real>(u_z_ptr[i] * unit_uz),
+                    static_cast<amrex::Real>(w_w_ptr[i] * unit_ww),
+                    pid, ip_offset + i, phys_const.c, enforceBC);
+            });
+
+        // on GPU the kernel above runs asynchronously while the next chunk is read
+        if (offset + chunk_size < num_to_add) load_chunk(1 - ibuf, offset + chunk_size);
+
+        // the buffer of this chunk is overwritten by the chunk after the next one
+        amrex::Gpu::streamSynchronize();
+        ibuf = 1 - ibuf;
+    }
 
     return physical_time;
 }
@@ -1,7 +1,6 @@
 #include "CoulombCollision.H"
 #include "Hipace.H"
 #include "ShuffleFisherYates.H"
-#include "particles/sorting/TileSort.H"
 #include "ElasticCollisionPerez.H"
 #include "utils/HipaceProfilerWrapper.H"
 
@@ -58,8 +57,9 @@ CoulombCollision::CoulombCollision(
 
 void
 CoulombCollision::doPlasmaPlasmaCoulombCollision (
-    int lev, const amrex::Box& bx, const amrex::Geometry& geom, PlasmaParticleContainer& species1,
-    PlasmaParticleContainer& species2, bool is_same_species, amrex::Real CoulombLog,
+    int lev, const amrex::Geometry& geom, PlasmaParticleContainer& species1,
+    PlasmaParticleContainer& species2, PlasmaBins& bins1, PlasmaBins& bins2, bool is_same_species,
+    amrex::Real CoulombLog,
     amrex::Real background_density_SI)
 {
     HIPACE_PROFILE("CoulombCollision::doCoulombCollision()");
@@ -80,8 +80,6 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
 
     if ( is_same_species ) // species_1 == species_2
     {
-        // Logically particles per-cell, and return indices of particles in each cell
-        PlasmaBins bins1 = findParticlesInEachTile(bx, 1, species1, geom);
         int const n_cells = bins1.numBins();
 
         // Counter to check there is only 1 box
@@ -90,10 +88,10 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
 
             // Get particles SoA data
             auto& soa1 = pti.GetStructOfArrays();
-            amrex::Real* const ux1 = soa1.GetRealData(PlasmaIdx::ux_half_step).data();
-            amrex::Real* const uy1 = soa1.GetRealData(PlasmaIdx::uy_half_step).data();
-            amrex::Real* const psi1 = soa1.GetRealData(PlasmaIdx::psi_half_step).data();
-            const amrex::Real* const w1 = soa1.GetRealData(PlasmaIdx::w).data();
+            amrex::ParticleReal* const ux1 = soa1.GetRealData(PlasmaIdx::ux_half_step).data();
+            amrex::ParticleReal* const uy1 = soa1.GetRealData(PlasmaIdx::uy_half_step).data();
+            amrex::ParticleReal* const psi1 = soa1.GetRealData(PlasmaIdx::psi_half_step).data();
+            const amrex::ParticleReal* const w1 = soa1.GetRealData(PlasmaIdx::w).data();
             const int* const ion_lev1 = soa1.GetIntData(PlasmaIdx::ion_lev).data();
             PlasmaBins::index_type * const indices1 = bins1.permutationPtr();
             PlasmaBins::index_type const * const offsets1 = bins1.offsetsPtr();
@@ -144,10 +142,6 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
 
     } else {
 
-        // Logically particles per-cell, and return indices of particles in each cell
-        PlasmaBins bins1 = findParticlesInEachTile(bx, 1, species1, geom);
-        PlasmaBins bins2 = findParticlesInEachTile(bx, 1, species2, geom);
-
         int const n_cells = bins1.numBins();
 
         // Counter to check there is only 1 box
@@ -156,10 +150,10 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
 
             // Get particles SoA data for species 1
             auto& soa1 = pti.GetStructOfArrays();
-            amrex::Real* const ux1 = soa1.GetRealData(PlasmaIdx::ux_half_step).data();
-            amrex::Real* const uy1 = soa1.GetRealData(PlasmaIdx::uy_half_step).data();
-            amrex::Real* const psi1 = soa1.GetRealData(PlasmaIdx::psi_half_step).data();
-            const amrex::Real* const w1 = soa1.GetRealData(PlasmaIdx::w).data();
+            amrex::ParticleReal* const ux1 = soa1.GetRealData(PlasmaIdx::ux_half_step).data();
+            amrex::ParticleReal* const uy1 = soa1.GetRealData(PlasmaIdx::uy_half_step).data();
+            amrex::ParticleReal* const psi1 = soa1.GetRealData(PlasmaIdx::psi_half_step).data();
+            const amrex::ParticleReal* const w1 = soa1.GetRealData(PlasmaIdx::w).data();
             const int* const ion_lev1 = soa1.GetIntData(PlasmaIdx::ion_lev).data();
             PlasmaBins::index_type * const indices1 = bins1.permutationPtr();
             PlasmaBins::index_type const * const offsets1 = bins1.offsetsPtr();
@@ -170,10 +164,10 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
             // Get particles SoA data for species 2
             auto& ptile2 = species2.ParticlesAt(lev, pti.index(), pti.LocalTileIndex());
             auto& soa2 = ptile2.GetStructOfArrays();
-            amrex::Real* const ux2 = soa2.GetRealData(PlasmaIdx::ux_half_step).data();
-            amrex::Real* const uy2 = soa2.GetRealData(PlasmaIdx::uy_half_step).data();
-            amrex::Real* const psi2= soa2.GetRealData(PlasmaIdx::psi_half_step).data();
-            const amrex::Real* const w2 = soa2.GetRealData(PlasmaIdx::w).data();
+            amrex::ParticleReal* const ux2 = soa2.GetRealData(PlasmaIdx::ux_half_step).data();
+            amrex::ParticleReal* const uy2 = soa2.GetRealData(PlasmaIdx::uy_half_step).data();
+            amrex::ParticleReal* const psi2 = soa2.GetRealData(PlasmaIdx::psi_half_step).data();
+            const amrex::ParticleReal* const w2 = soa2.GetRealData(PlasmaIdx::w).data();
             const int* const ion_lev2 = soa2.GetIntData(PlasmaIdx::ion_lev).data();
             PlasmaBins::index_type * const indices2 = bins2.permutationPtr();
             PlasmaBins::index_type const * const offsets2 = bins2.offsetsPtr();
@@ -237,8 +231,9 @@ CoulombCollision::doPlasmaPlasmaCoulombCollision (
 
 void
 CoulombCollision::doBeamPlasmaCoulombCollision (
-    int lev, const amrex::Box& bx, const amrex::Geometry& geom,
-    BeamParticleContainer& species1, PlasmaParticleContainer& species2, amrex::Real CoulombLog,
+    int lev, const amrex::Geometry& geom,
+    BeamParticleContainer& species1, PlasmaParticleContainer& species2,
+    BeamBins& bins1, PlasmaBins& bins2, amrex::Real CoulombLog,
     amrex::Real background_density_SI)
 {
     HIPACE_PROFILE("CoulombCollision::doBeamPlasmaCoulombCollision()");
@@ -257,10 +252,6 @@ CoulombCollision::doBeamPlasmaCoulombCollision (
     constexpr amrex::Real inv_c_SI = 1.0_rt / PhysConstSI::c;
     constexpr amrex::Real inv_c2_SI = 1.0_rt / ( PhysConstSI::c * PhysConstSI::c );
 
-    // Logically particles per-cell, and return indices of particles in each cell
-    BeamBins bins1 = findBeamParticlesInEachTile(bx, 1, species1, geom);
-    PlasmaBins bins2 = findParticlesInEachTile(bx, 1, species2, geom);
-
     int const n_cells = bins2.numBins();
 
     // Counter to check there is only 1 box
@@ -269,10 +260,10 @@ CoulombCollision::doBeamPlasmaCoulombCollision (
 
         // // Get particles SoA data for species 1
         auto& soa1 = species1.getBeamSlice(WhichBeamSlice::This).GetStructOfArrays();
-        amrex::Real* const ux1 = soa1.GetRealData(BeamIdx::ux).data();
-        amrex::Real* const uy1 = soa1.GetRealData(BeamIdx::uy).data();
-        amrex::Real* const psi1 = soa1.GetRealData(BeamIdx::uz).data();
-        const amrex::Real* const w1 = soa1.GetRealData(BeamIdx::w).data();
+        amrex::ParticleReal* const ux1 = soa1.GetRealData(BeamIdx::ux).data();
+        amrex::ParticleReal* const uy1 = soa1.GetRealData(BeamIdx::uy).data();
+        amrex::ParticleReal* const psi1 = soa1.GetRealData(BeamIdx::uz).data();
+        const amrex::ParticleReal* const w1 = soa1.GetRealData(BeamIdx::w).data();
         BeamBins::index_type * const indices1 = bins1.permutationPtr();
         BeamBins::index_type const * const offsets1 = bins1.offsetsPtr();
         amrex::Real q1 = species1.GetCharge();
@@ -282,10 +273,10 @@ CoulombCollision::doBeamPlasmaCoulombCollision (
         // Get particles SoA data for species 2
         //auto& ptile2 = species2.ParticlesAt(lev, pti.index(), pti.LocalTileIndex());
         auto& soa2 = pti.GetStructOfArrays();
-        amrex::Real* const ux2 = soa2.GetRealData(PlasmaIdx::ux_half_step).data();
-        amrex::Real* const uy2 = soa2.GetRealData(PlasmaIdx::uy_half_step).data();
-        amrex::Real* const psi2= soa2.GetRealData(PlasmaIdx::psi_half_step).data();
-        const amrex::Real* const w2 = soa2.GetRealData(PlasmaIdx::w).data();
+        amrex::ParticleReal* const ux2 = soa2.GetRealData(PlasmaIdx::ux_half_step).data();
+        amrex::ParticleReal* const uy2 = soa2.GetRealData(PlasmaIdx::uy_half_step).data();
+        amrex::ParticleReal* const psi2 = soa2.GetRealData(PlasmaIdx::psi_half_step).data();
+        const amrex::ParticleReal* const w2 = soa2.GetRealData(PlasmaIdx::w).data();
         const int* const ion_lev2 = soa2.GetIntData(PlasmaIdx::ion_lev).data();
         PlasmaBins::index_type * const indices2 = bins2.permutationPtr();
         PlasmaBins::index_type const * const offsets2 = bins2.offsetsPtr();
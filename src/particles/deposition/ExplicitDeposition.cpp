@@ -56,6 +56,11 @@ ExplicitDeposition (PlasmaParticleContainer& plasma, Fields& fields,
         const amrex::Real charge_invvol_mu0 = plasma.m_charge * invvol * pc.mu0;
         const amrex::Real charge_mass_ratio = plasma.m_charge / plasma.m_mass;
 
+        // maybe reuse the tile bins from the previous deposition for the tiled deposition on CPU
+        PersistentBins<PlasmaParticleContainer::ParticleTileType::ParticleTileDataType>* const
+        persistent_bins = (Hipace::m_persistent_particle_bins && lev == 0) ?
+            &plasma.m_deposition_bins : nullptr;
+
         amrex::AnyCTO(
             // use compile-time options
             amrex::TypeList<
@@ -84,14 +89,16 @@ ExplicitDeposition (PlasmaParticleContainer& plasma, Fields& fields,
                         int(pti.numParticles()), is_valid, get_cell, deposit, isl_fab.array(),
                         isl_fab.box(), pti.GetParticleTile().getParticleTileData(),
                         amrex::GpuArray<int, 5>{Bz, Ez, ExmBy, EypBx, aabs_comp},
-                        amrex::GpuArray<int, 2>{Sy, Sx});
+                        amrex::GpuArray<int, 2>{Sy, Sx},
+                        persistent_bins);
                 } else {
                     constexpr int stencil_size = depos_order + derivative_type + 1;
                     SharedMemoryDeposition<stencil_size, stencil_size, false>(
                         int(pti.numParticles()), is_valid, get_cell, deposit, isl_fab.array(),
                         isl_fab.box(), pti.GetParticleTile().getParticleTileData(),
                         amrex::GpuArray<int, 4>{Bz, Ez, ExmBy, EypBx},
-                        amrex::GpuArray<int, 2>{Sy, Sx});
+                        amrex::GpuArray<int, 2>{Sy, Sx},
+                        persistent_bins);
                 }
             },
             // is_valid
@@ -87,6 +87,11 @@ DepositCurrent (PlasmaParticleContainer& plasma, Fields & fields,
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(isl_fab.box().ixType().cellCentered(),
             "jx, jy, jz, and rho must be cell centered in all directions.");
 
+        // maybe reuse the tile bins from the previous deposition for the tiled deposition on CPU
+        PersistentBins<PlasmaParticleContainer::ParticleTileType::ParticleTileDataType>* const
+        persistent_bins = (Hipace::m_persistent_particle_bins && lev == 0) ?
+            &plasma.m_deposition_bins : nullptr;
+
         // Loop over particles and deposit into jx_fab, jy_fab, jz_fab, and rho_fab
         amrex::AnyCTO(
             // use compile-time options
@@ -112,13 +117,15 @@ DepositCurrent (PlasmaParticleContainer& plasma, Fields & fields,
                         int(pti.numParticles()), is_valid, get_cell, deposit, isl_fab.array(),
                         isl_fab.box(), pti.GetParticleTile().getParticleTileData(),
                         amrex::GpuArray<int, 1>{aabs},
-                        amrex::GpuArray<int, 6>{jx, jy, jz, rho, chi, rhomjz});
+                        amrex::GpuArray<int, 6>{jx, jy, jz, rho, chi, rhomjz},
+                        persistent_bins);
                 } else {
                     SharedMemoryDeposition<stencil_size, stencil_size, true>(
                         int(pti.numParticles()), is_valid, get_cell, deposit, isl_fab.array(),
                         isl_fab.box(), pti.GetParticleTile().getParticleTileData(),
                         amrex::GpuArray<int, 0>{},
-                        amrex::GpuArray<int, 6>{jx, jy, jz, rho, chi, rhomjz});
+                        amrex::GpuArray<int, 6>{jx, jy, jz, rho, chi, rhomjz},
+                        persistent_bins);
                 }
             },
             // is_valid
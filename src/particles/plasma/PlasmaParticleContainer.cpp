@@ -98,6 +98,19 @@ PlasmaParticleContainer::ReadParameters ()
 
     queryWithParserAlt(pp, "min_density", m_min_density, pp_alt);
 
+    std::string density_tabulation = "none";
+    queryWithParserAlt(pp, "density_tabulation", density_tabulation, pp_alt);
+    if (density_tabulation == "none") {
+        m_density_tabulation = 0;
+    } else if (density_tabulation == "exact") {
+        m_density_tabulation = 1;
+    } else if (density_tabulation == "interpolate") {
+        m_density_tabulation = 2;
+    } else {
+        amrex::Abort("Unknown plasma density_tabulation '" + density_tabulation +
+                     "', must be none, exact or interpolate");
+    }
+
     std::string density_table_file_name{};
     m_use_density_table = queryWithParser(pp, "density_table_file", density_table_file_name);
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(density_func_specified && m_use_density_table),
@@ -190,6 +203,7 @@ PlasmaParticleContainer::InitData (const amrex::Geometry& geom)
         m_insitu_idata.resize(m_nslices*m_insitu_nip, 0);
         m_insitu_sum_rdata.resize(m_insitu_nrp, 0.);
         m_insitu_sum_idata.resize(m_insitu_nip, 0);
+        m_insitu_acc.resize(m_nslices);
     }
 }
 
@@ -213,6 +227,9 @@ PlasmaParticleContainer::UpdateDensityFunction (const amrex::Real pos_z)
     if (!m_use_density_table) return;
     auto iter = m_density_table.lower_bound(pos_z);
     if (iter == m_density_table.end()) --iter;
+    // only compile the parser again if a different entry of the table is used
+    if (iter->first == m_density_table_pos) return;
+    m_density_table_pos = iter->first;
     m_density_func = makeFunctionWithParser<3>(iter->second, m_parser, {"x", "y", "z"});
 }
 
@@ -226,9 +243,9 @@ PlasmaParticleContainer::TagByLevel (const int current_N_level,
     for (PlasmaParticleIterator pti(*this); pti.isValid(); ++pti)
     {
         auto& soa = pti.GetStructOfArrays();
-        const amrex::Real * const AMREX_RESTRICT pos_x = to_prev ?
+        const amrex::ParticleReal * const AMREX_RESTRICT pos_x = to_prev ?
             soa.GetRealData(PlasmaIdx::x_prev).data() : soa.GetRealData(PlasmaIdx::x).data();
-        const amrex::Real * const AMREX_RESTRICT pos_y = to_prev ?
+        const amrex::ParticleReal * const AMREX_RESTRICT pos_y = to_prev ?
             soa.GetRealData(PlasmaIdx::y_prev).data() : soa.GetRealData(PlasmaIdx::y).data();
         auto * AMREX_RESTRICT idcpup = soa.GetIdCPUData().data();
 
@@ -310,24 +327,26 @@ IonizationModule (const int lev,
                                wp * PhysConstSI::m_e * PhysConstSI::c / PhysConstSI::q_e : 1;
 
         int * const ion_lev = soa_ion.GetIntData(PlasmaIdx::ion_lev).data();
-        const amrex::Real * const x_prev = soa_ion.GetRealData(PlasmaIdx::x_prev).data();
-        const amrex::Real * const y_prev = soa_ion.GetRealData(PlasmaIdx::y_prev).data();
-        const amrex::Real * const uxp = soa_ion.GetRealData(PlasmaIdx::ux_half_step).data();
-        const amrex::Real * const uyp = soa_ion.GetRealData(PlasmaIdx::uy_half_step).data();
-        const amrex::Real * const psip =soa_ion.GetRealData(PlasmaIdx::psi_half_step).data();
+        const amrex::ParticleReal * const x_prev = soa_ion.GetRealData(PlasmaIdx::x_prev).data();
+        const amrex::ParticleReal * const y_prev = soa_ion.GetRealData(PlasmaIdx::y_prev).data();
+        const amrex::ParticleReal * const uxp = soa_ion.GetRealData(PlasmaIdx::ux_half_step).data();
+        const amrex::ParticleReal * const uyp = soa_ion.GetRealData(PlasmaIdx::uy_half_step).data();
+        const amrex::ParticleReal * const psip = soa_ion.GetRealData(PlasmaIdx::psi_half_step).data();
         const auto * idcpup = soa_ion.GetIdCPUData().data();
 
+        long num_ions = ptile_ion.numParticles();
+
         // Make Ion Mask and load ADK prefactors
         // Ion Mask is necessary to only resize electron particle tile once
-        amrex::Gpu::DeviceVector<uint8_t> ion_mask(ptile_ion.numParticles(), 0);
-        uint8_t* AMREX_RESTRICT p_ion_mask = ion_mask.data();
-        amrex::Gpu::DeviceScalar<uint32_t> num_new_electrons(0);
-        uint32_t* AMREX_RESTRICT p_num_new_electrons = num_new_electrons.dataPtr();
+        amrex::Gpu::DeviceVector<int> ion_mask(num_ions, 0);
+        int* AMREX_RESTRICT p_ion_mask = ion_mask.data();
         amrex::Real* AMREX_RESTRICT adk_prefactor = m_adk_prefactor.data();
         amrex::Real* AMREX_RESTRICT adk_exp_prefactor = m_adk_exp_prefactor.data();
         amrex::Real* AMREX_RESTRICT adk_power = m_adk_power.data();
-
-        long num_ions = ptile_ion.numParticles();
+        const int adk_table_size = m_adk_table_size;
+        const amrex::Real* AMREX_RESTRICT adk_table = m_adk_table.data();
+        const amrex::Real* AMREX_RESTRICT adk_table_lo = m_adk_table_lo.data();
+        const amrex::Real* AMREX_RESTRICT adk_table_dinv = m_adk_table_dinv.data();
 
         amrex::AnyCTO(
             amrex::TypeList<
@@ -366,10 +385,22 @@ IonizationModule (const int lev,
                                                + uyp[ip] * uyp[ip] * clightsq
                                                + psip[ip]* psip[ip] ) / ( 2.0_rt * psip[ip] );
             const int ion_lev_loc = ion_lev[ip];
+            // interpolate ln(w) linearly in ln(E) if the ADK rate is tabulated
+            const amrex::Real t_table = adk_table_size > 0 ?
+                (std::log(Ep) - adk_table_lo[ion_lev_loc]) * adk_table_dinv[ion_lev_loc] : 0._rt;
+            amrex::Real w_adk = 0._rt;
+            if (adk_table_size == 0 || t_table >= adk_table_size - 1) {
+                w_adk = adk_prefactor[ion_lev_loc] * std::pow(Ep, adk_power[ion_lev_loc]) *
+                        std::exp( adk_exp_prefactor[ion_lev_loc]/Ep );
+            } else if (t_table >= 0._rt) {
+                const int k_table = static_cast<int>(t_table);
+                const amrex::Real f_table = t_table - k_table;
+                const amrex::Real* const table_lev = adk_table + ion_lev_loc * adk_table_size;
+                w_adk = std::exp( (1._rt - f_table) * table_lev[k_table]
+                                  + f_table * table_lev[k_table+1] );
+            }
             // gamma / (psi + 1) to complete dt for QSA
-            amrex::Real w_dtau = gammap / psip[ip] * adk_prefactor[ion_lev_loc] *
-                std::pow(Ep, adk_power[ion_lev_loc]) *
-                std::exp( adk_exp_prefactor[ion_lev_loc]/Ep );
+            amrex::Real w_dtau = gammap / psip[ip] * w_adk;
             amrex::Real p = 1._rt - std::exp( - w_dtau );
 
             amrex::Real random_draw = amrex::Random(engine);
@@ -377,22 +408,27 @@ IonizationModule (const int lev,
             {
                 ion_lev[ip] += 1;
                 p_ion_mask[ip] = 1;
-                amrex::Gpu::Atomic::Add( p_num_new_electrons, 1u );
             }
         });
-        amrex::Gpu::streamSynchronize();
 
-        if (num_new_electrons.dataValue() == 0) continue;
+        // the exclusive sum of the mask is the index of every new electron in the product tile.
+        // Getting the total number also synchronizes the stream
+        amrex::Gpu::DeviceVector<int> elec_offset(num_ions);
+        int* AMREX_RESTRICT p_elec_offset = elec_offset.data();
+        const int num_new_electrons =
+            amrex::Scan::ExclusiveSum(int(num_ions), p_ion_mask, p_elec_offset);
+
+        if (num_new_electrons == 0) continue;
 
         if(Hipace::m_verbose >= 3) {
             amrex::Print() << "Number of ionized Plasma Particles: "
-            << num_new_electrons.dataValue() << "\n";
+            << num_new_electrons << "\n";
         }
 
 
         // resize electron particle tile
         const auto old_size = ptile_elec.numParticles();
-        const auto new_size = old_size + num_new_electrons.dataValue();
+        const auto new_size = old_size + num_new_electrons;
         ptile_elec.resize(new_size);
 
         // Load electron soa and aos after resize
@@ -403,15 +439,11 @@ IonizationModule (const int lev,
 
         const int init_ion_lev = m_product_pc->m_init_ion_lev;
 
-        amrex::Gpu::DeviceScalar<uint32_t> ip_elec(0);
-        uint32_t * AMREX_RESTRICT p_ip_elec = ip_elec.dataPtr();
-
         amrex::ParallelFor(num_ions,
             [=] AMREX_GPU_DEVICE (long ip) {
 
             if(p_ion_mask[ip] != 0) {
-                const long pid = amrex::Gpu::Atomic::Add( p_ip_elec, 1u );
-                const long pidx = pid + old_size;
+                const long pidx = p_elec_offset[ip] + old_size;
 
                 // Copy ion data to new electron
                 amrex::ParticleIDWrapper{idcpu_elec[pidx]} = 2; // only for valid/invalid
@@ -441,7 +473,7 @@ IonizationModule (const int lev,
             }
         });
 
-        // synchronize before ion_mask and ip_elec go out of scope
+        // synchronize before ion_mask and elec_offset go out of scope
         amrex::Gpu::streamSynchronize();
     }
 }
@@ -453,8 +485,7 @@ PlasmaParticleContainer::InSituComputeDiags (int islice)
 
     using namespace amrex::literals;
 
-    AMREX_ALWAYS_ASSERT(m_insitu_rdata.size()>0 && m_insitu_idata.size()>0 &&
-                        m_insitu_sum_rdata.size()>0 && m_insitu_sum_idata.size()>0);
+    AMREX_ALWAYS_ASSERT(!m_insitu_acc.empty());
 
     const amrex::Real insitu_radius_sq = m_insitu_radius * m_insitu_radius;
     const PhysConst phys_const = get_phys_const();
@@ -468,12 +499,11 @@ PlasmaParticleContainer::InSituComputeDiags (int islice)
 
         amrex::Long const num_particles = pti.numParticles();
 
-        amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpSum[m_insitu_nrp + m_insitu_nip]> reduce_op;
-        amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[m_insitu_nrp], int[m_insitu_nip]> reduce_data(reduce_op);
-        using ReduceTuple = typename decltype(reduce_data)::Type;
-        reduce_op.eval(
-            num_particles, reduce_data,
-            [=] AMREX_GPU_DEVICE (int ip) -> ReduceTuple
+        // the results stay on the device until InSituWriteToFile,
+        // so there is no synchronization here
+        m_insitu_acc.Reduce(islice, num_particles,
+            [=] AMREX_GPU_DEVICE (amrex::Long ip)
+                -> amrex::GpuArray<amrex::Real, m_insitu_nrp + m_insitu_nip>
             {
                 const amrex::Real x = ptd.pos(0, ip);
                 const amrex::Real y = ptd.pos(1, ip);
@@ -482,7 +512,7 @@ PlasmaParticleContainer::InSituComputeDiags (int islice)
                 const amrex::Real psi = ptd.rdata(PlasmaIdx::psi)[ip];
 
                 if (!ptd.id(ip).is_valid() || x*x + y*y > insitu_radius_sq) {
-                    return amrex::IdentityTuple(ReduceTuple{}, reduce_op);
+                    return {};
                 }
                 // particle's Lorentz factor
                 const amrex::Real gamma = (1.0_rt + ux*ux + uy*uy + psi*psi)/(2.0_rt*psi);
@@ -492,7 +522,7 @@ PlasmaParticleContainer::InSituComputeDiags (int islice)
                 const amrex::Real w = ptd.rdata(PlasmaIdx::w)[ip] * gamma/psi;
                 // no quasi-static weighting factor to calculate quasi-static energy
                 const amrex::Real energy = ptd.rdata(PlasmaIdx::w)[ip] * (gamma - 1._rt);
-                return {            // Tuple contains:
+                return {            // Array contains:
                     w,              // 0    sum(w)
                     w*x,            // 1    [x]
                     w*x*x,          // 2    [x^2]
@@ -507,28 +537,34 @@ PlasmaParticleContainer::InSituComputeDiags (int islice)
                     w*gamma,        // 11   [ga]
                     w*gamma*gamma,  // 12   [ga^2]
                     energy,         // 13   [(ga-1)*(1-vz)]
-                    1               // 14   Np
+                    1._rt           // 14   Np
                 };
             });
+    }
+}
 
-        auto [real_tup, int_tup] = amrex::TupleSplit<m_insitu_nrp, m_insitu_nip>(reduce_data.value());
-
-        auto real_arr = amrex::tupleToArray(real_tup);
+void
+PlasmaParticleContainer::InSituCopyToHost ()
+{
+    // get the data of all slices from the device
+    m_insitu_acc.CopyToHost();
 
-        const amrex::Real sum_w_inv = real_arr[0] <= 0._rt ? 0._rt : 1._rt / real_arr[0];
+    for (int islice=0; islice<m_nslices; ++islice) {
+        const double sum_w = m_insitu_acc.get(islice, 0);
+        const double sum_w_inv = sum_w <= 0. ? 0. : 1. / sum_w;
 
         for (int i=0; i<m_insitu_nrp; ++i) {
-            m_insitu_rdata[islice + i * m_nslices] = real_arr[i] *
+            const double val = m_insitu_acc.get(islice, i);
+            m_insitu_rdata[islice + i * m_nslices] = static_cast<amrex::Real>(val *
                 // sum(w) and [(ga-1)*(1-vz)] are not multiplied by sum_w_inv
-                ( i == 0 || i == (m_insitu_nrp-1) ? 1 : sum_w_inv );
-            m_insitu_sum_rdata[i] += real_arr[i];
+                ( i == 0 || i == (m_insitu_nrp-1) ? 1. : sum_w_inv ));
+            m_insitu_sum_rdata[i] += static_cast<amrex::Real>(val);
         }
 
-        auto int_arr = amrex::tupleToArray(int_tup);
-
         for (int i=0; i<m_insitu_nip; ++i) {
-            m_insitu_idata[islice + i * m_nslices] = int_arr[i];
-            m_insitu_sum_idata[i] += int_arr[i];
+            const int val = static_cast<int>(m_insitu_acc.get(islice, m_insitu_nrp + i));
+            m_insitu_idata[islice + i * m_nslices] = val;
+            m_insitu_sum_idata[i] += val;
         }
     }
 }
@@ -552,6 +588,8 @@ PlasmaParticleContainer::InSituWriteToFile (int step, amrex::Real time, const am
     std::ofstream ofs{m_insitu_file_prefix + "/reduced_" + m_name + "." + pad_rank_num + ".txt",
         std::ofstream::out | std::ofstream::app | std::ofstream::binary};
 
+    InSituCopyToHost();
+
     const amrex::Real sum_w0 = m_insitu_sum_rdata[0];
     const std::size_t nslices = static_cast<std::size_t>(m_nslices);
     const amrex::Real normalized_density_factor = Hipace::m_normalized_units ?
@@ -14,6 +14,54 @@
 #include "utils/IonizationEnergiesTable.H"
 #include <cmath>
 
+namespace
+{
+    /** \brief Plasma density at the initial position of a particle, either evaluated with the
+     * density function or read from a table that is computed once per call to InitParticles
+     */
+    struct PlasmaDensityLookup
+    {
+        /** density function of the plasma */
+        amrex::ParserExecutor<3> m_density_func;
+        /** longitudinal position at which the density function is evaluated */
+        amrex::Real m_c_t;
+        /** see PlasmaParticleContainer::m_density_tabulation */
+        int m_mode = 0;
+        /** table of density values */
+        const amrex::Real* m_table = nullptr;
+        /** lower corner of the tile box */
+        int m_lo_x = 0, m_lo_y = 0;
+        /** strides of the table in y and in the particle index within the cell */
+        int m_stride_y = 0, m_stride_ppc = 0;
+
+        /** \brief get the density
+         *
+         * \param[in] i cell index in x
+         * \param[in] j cell index in y
+         * \param[in] i_part particle index within the cell
+         * \param[in] r position of the particle within the cell, between 0 and 1
+         * \param[in] x position of the particle in x
+         * \param[in] y position of the particle in y
+         */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        amrex::Real operator() (int i, int j, int i_part, const amrex::Real r[2],
+                                amrex::Real x, amrex::Real y) const noexcept
+        {
+            using namespace amrex::literals;
+            const int idx = (i - m_lo_x) + (j - m_lo_y) * m_stride_y;
+            if (m_mode == 1) {
+                return m_table[idx + i_part * m_stride_ppc];
+            } else if (m_mode == 2) {
+                return (1._rt-r[0]) * (1._rt-r[1]) * m_table[idx]
+                     +        r[0]  * (1._rt-r[1]) * m_table[idx + 1]
+                     + (1._rt-r[0]) *        r[1]  * m_table[idx + m_stride_y]
+                     +        r[0]  *        r[1]  * m_table[idx + m_stride_y + 1];
+            }
+            return m_density_func(x, y, m_c_t);
+        }
+    };
+}
+
 void
 PlasmaParticleContainer::
 InitParticles (const amrex::RealVect& a_u_std,
@@ -138,6 +186,49 @@ InitParticles (const amrex::RealVect& a_u_std,
             }
         }
 
+        // Evaluate the density function once per particle position or once per cell node,
+        // so the passes below only need to read a table
+        PlasmaDensityLookup density{density_func, c_t, m_density_tabulation};
+        amrex::Gpu::DeviceVector<amrex::Real> density_table;
+        if (m_density_tabulation != 0) {
+            const int nx = tile_box.length(0) + (m_density_tabulation == 2 ? 1 : 0);
+            const int ny = tile_box.length(1) + (m_density_tabulation == 2 ? 1 : 0);
+            const int nppc = m_density_tabulation == 1 ? num_ppc_fine : 1;
+            density_table.resize(amrex::Long(nx) * ny * nppc);
+            amrex::Real * const p_table = density_table.dataPtr();
+            const int mode = m_density_tabulation;
+
+            amrex::ParallelFor(amrex::Long(nx) * ny * nppc,
+                [=] AMREX_GPU_DEVICE (amrex::Long idx) noexcept
+                {
+                    const int i_part = static_cast<int>(idx / (amrex::Long(nx) * ny));
+                    const int j = lo.y + static_cast<int>((idx / nx) % ny);
+                    const int i = lo.x + static_cast<int>(idx % nx);
+
+                    amrex::Real r[2] = {0._rt, 0._rt};
+                    if (mode == 1) {
+                        bool do_init = false;
+                        ParticleUtil::get_position_unit_cell_fine(r, do_init, i_part,
+                            ppc_coarse, ppc_fine, fine_transition_cells,
+                            use_fine_patch ? arr_fine(i, j, comp_a) : 0);
+                        if (!do_init) {
+                            p_table[idx] = 0._rt;
+                            return;
+                        }
+                    }
+
+                    const amrex::Real x = plo[0] + (i + r[0] + x_offset)*dx[0];
+                    const amrex::Real y = plo[1] + (j + r[1] + y_offset)*dx[1];
+                    p_table[idx] = density_func(x, y, c_t);
+                });
+
+            density.m_table = p_table;
+            density.m_lo_x = lo.x;
+            density.m_lo_y = lo.y;
+            density.m_stride_y = nx;
+            density.m_stride_ppc = nx * ny;
+        }
+
         // Count the total number of particles so only one resize is needed
         amrex::Long total_num_particles = amrex::Reduce::Sum<amrex::Long>(tile_box.numPts(),
             [=] AMREX_GPU_DEVICE (amrex::Long idx) noexcept
@@ -163,7 +254,7 @@ InitParticles (const amrex::RealVect& a_u_std,
                         y >= a_bounds.hi(1) || y < a_bounds.lo(1) ||
                         rsq > a_radius*a_radius ||
                         rsq < a_hollow_core_radius*a_hollow_core_radius ||
-                        density_func(x, y, c_t) <= min_density) continue;
+                        density(i, j, i_part, r, x, y) <= min_density) continue;
 
                     num_particles_cell += 1;
                 }
@@ -216,7 +307,7 @@ InitParticles (const amrex::RealVect& a_u_std,
                     y >= a_bounds.hi(1) || y < a_bounds.lo(1) ||
                     rsq > a_radius*a_radius ||
                     rsq < a_hollow_core_radius*a_hollow_core_radius ||
-                    density_func(x, y, c_t) <= min_density) return;
+                    density(i, j, i_part, r, x, y) <= min_density) return;
 
                 int ix = i - lo.x;
                 int iy = j - lo.y;
@@ -276,7 +367,7 @@ InitParticles (const amrex::RealVect& a_u_std,
                     y >= a_bounds.hi(1) || y < a_bounds.lo(1) ||
                     rsq > a_radius*a_radius ||
                     rsq < a_hollow_core_radius*a_hollow_core_radius ||
-                    density_func(x, y, c_t) <= min_density) return;
+                    density(i, j, i_part, r, x, y) <= min_density) return;
 
                 amrex::Real u[3] = {0.,0.,0.};
                 ParticleUtil::get_gaussian_random_momentum(u, a_u_mean, a_u_std, engine);
@@ -287,10 +378,10 @@ InitParticles (const amrex::RealVect& a_u_std,
                 ptd.rdata(PlasmaIdx::y)[pidx] = y;
 
                 if (use_fine_patch) {
-                    ptd.rdata(PlasmaIdx::w)[pidx] = density_func(x, y, c_t) *
+                    ptd.rdata(PlasmaIdx::w)[pidx] = density(i, j, i_part, r, x, y) *
                         (arr_fine(i, j, comp_a) == 0 ? scale_fac_coarse : scale_fac_fine);
                 } else {
-                    ptd.rdata(PlasmaIdx::w)[pidx] = density_func(x, y, c_t) * scale_fac_coarse;
+                    ptd.rdata(PlasmaIdx::w)[pidx] = density(i, j, i_part, r, x, y) * scale_fac_coarse;
                 }
 
                 ptd.rdata(PlasmaIdx::ux)[pidx] = u[0] * c_light;
@@ -458,4 +549,46 @@ InitIonizationModule (const amrex::Geometry& geom, PlasmaParticleContainer* prod
         h_adk_prefactor.begin(), h_adk_prefactor.end(), m_adk_prefactor.begin());
     amrex::Gpu::copy(amrex::Gpu::hostToDevice,
         h_adk_exp_prefactor.begin(), h_adk_exp_prefactor.end(), m_adk_exp_prefactor.begin());
+
+    amrex::ParmParse pp_alt("plasmas");
+    queryWithParserAlt(pp, "ionization_table_size", m_adk_table_size, pp_alt);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_adk_table_size == 0 || m_adk_table_size >= 2,
+        "ionization_table_size must be 0 (off) or at least 2");
+    if (m_adk_table_size == 0) return;
+
+    // Tabulate ln(w) = ln(prefactor) + power * ln(E) + exp_prefactor / E over ln(E) for every
+    // ion level, so that the rate only needs one interpolation instead of pow and exp.
+    // Below the table the exponent is less than -200, so the rate is set to zero.
+    // Above the table, where the exponent is larger than -0.1, the formula is evaluated.
+    constexpr double exp_lo = 200.;
+    constexpr double exp_hi = 0.1;
+    const int n_table = m_adk_table_size;
+    m_adk_table.resize(ion_atomic_number * n_table);
+    m_adk_table_lo.resize(ion_atomic_number);
+    m_adk_table_dinv.resize(ion_atomic_number);
+
+    amrex::Gpu::PinnedVector<amrex::Real> h_adk_table(ion_atomic_number * n_table);
+    amrex::Gpu::PinnedVector<amrex::Real> h_adk_table_lo(ion_atomic_number);
+    amrex::Gpu::PinnedVector<amrex::Real> h_adk_table_dinv(ion_atomic_number);
+
+    for (int i=0; i<ion_atomic_number; ++i)
+    {
+        const double ln_E_lo = std::log(-double(h_adk_exp_prefactor[i]) / exp_lo);
+        const double ln_E_hi = std::log(-double(h_adk_exp_prefactor[i]) / exp_hi);
+        const double d_ln_E = (ln_E_hi - ln_E_lo) / (n_table - 1);
+        for (int k=0; k<n_table; ++k) {
+            const double ln_E = ln_E_lo + k * d_ln_E;
+            h_adk_table[i*n_table + k] = std::log(double(h_adk_prefactor[i]))
+                + h_adk_power[i] * ln_E + h_adk_exp_prefactor[i] * std::exp(-ln_E);
+        }
+        h_adk_table_lo[i] = ln_E_lo;
+        h_adk_table_dinv[i] = 1. / d_ln_E;
+    }
+
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice,
+        h_adk_table.begin(), h_adk_table.end(), m_adk_table.begin());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice,
+        h_adk_table_lo.begin(), h_adk_table_lo.end(), m_adk_table_lo.begin());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice,
+        h_adk_table_dinv.begin(), h_adk_table_dinv.end(), m_adk_table_dinv.begin());
 }
@@ -30,7 +30,12 @@ AdvanceBeamParticlesSlice (
     const int n_subcycles = beam.m_n_subcycles;
     const bool radiation_reaction = beam.m_do_radiation_reaction;
     const amrex::Real time = Hipace::GetInstance().m_physical_time;
-    const amrex::Real dt = Hipace::GetInstance().m_dt / n_subcycles;
+    const amrex::Real dt_sub = Hipace::GetInstance().m_dt / n_subcycles;
+    const bool adaptive_subcycling = beam.m_adaptive_subcycling;
+    const amrex::Real adaptive_tolerance = beam.m_adaptive_subcycling_tolerance;
+    const int adaptive_max_merge = beam.m_adaptive_subcycling_max_merge;
+    unsigned long long* const p_subcycle_counters = adaptive_subcycling ?
+        beam.m_subcycle_counters.dataPtr() : nullptr;
     const amrex::Real background_density_SI = Hipace::m_background_density_SI;
     const bool normalized_units = Hipace::m_normalized_units;
     const bool spin_tracking = beam.m_do_spin_tracking;
@@ -137,6 +142,13 @@ AdvanceBeamParticlesSlice (
             amrex::Real uz = ptd.rdata(BeamIdx::uz)[ip];
 
             int i = ptd.idata(BeamIdx::nsubcycles)[ip];
+            const int i_start = i;
+
+            // with adaptive sub-cycling, n_merge sub-cycles are done in one step
+            int n_merge = 1;
+            int n_steps = 0;
+            // force per unit time of the last step, to estimate the error of merging steps
+            amrex::ParticleReal fx_prev = 0._rt, fy_prev = 0._rt, fz_prev = 0._rt;
 
             amrex::RealVect spin {0._rt, 0._rt, 0._rt};
             if (spin_tracking) {
@@ -145,13 +157,20 @@ AdvanceBeamParticlesSlice (
                 spin[2] = ptd.m_runtime_rdata[2][ip];
             }
 
-            for (; i < n_subcycles; i++) {
+            while (i < n_subcycles) {
 
                 if (zp < min_z) {
                     // stop pushing particle if it is not on this slice anymore
                     break;
                 }
 
+                if (adaptive_subcycling) {
+                    n_merge = amrex::min(n_merge, n_subcycles - i);
+                }
+                // number of sub-cycles covered by this step, n_merge is changed for the next one
+                const int n_used = n_merge;
+                const amrex::Real dt = dt_sub * n_used;
+
                 const amrex::ParticleReal gammap_inv = 1._rt / std::sqrt( 1._rt
                     + (ux*ux + uy*uy + uz*uz)*inv_c2 );
 
@@ -314,10 +333,44 @@ AdvanceBeamParticlesSlice (
                 xp += dt * 0.5_rt * ux_next * gamma_next_inv;
                 yp += dt * 0.5_rt * uy_next * gamma_next_inv;
                 if (do_z_push) zp += dt * ( uz_next * gamma_next_inv - clight );
+
+                if (adaptive_subcycling) {
+                    // Estimate the error from the change of the force between two steps.
+                    // If it is small, the fields are smooth along the trajectory and more
+                    // sub-cycles can be merged into one step, otherwise go back to single steps.
+                    const amrex::Real dt_inv = 1._rt / dt;
+                    const amrex::ParticleReal fx = (ux_next - ux) * dt_inv;
+                    const amrex::ParticleReal fy = (uy_next - uy) * dt_inv;
+                    const amrex::ParticleReal fz = (uz_next - uz) * dt_inv;
+                    if (n_steps > 0) {
+                        const amrex::ParticleReal df = std::abs(fx - fx_prev)
+                            + std::abs(fy - fy_prev) + std::abs(fz - fz_prev);
+                        const amrex::ParticleReal f = std::abs(fx) + std::abs(fy) + std::abs(fz)
+                            + std::abs(fx_prev) + std::abs(fy_prev) + std::abs(fz_prev);
+                        if (df <= adaptive_tolerance * f) {
+                            n_merge = amrex::min(2 * n_merge, adaptive_max_merge);
+                        } else if (df > 4._rt * adaptive_tolerance * f) {
+                            n_merge = 1;
+                        }
+                    }
+                    fx_prev = fx;
+                    fy_prev = fy;
+                    fz_prev = fz;
+                }
+                ++n_steps;
+                i += n_used;
+
                 ux = ux_next;
                 uy = uy_next;
                 uz = uz_next;
-            } // end for loop over n_subcycles
+            } // end loop over n_subcycles
+            if (adaptive_subcycling) {
+                // count the computed steps and the sub-cycles they cover
+                amrex::HostDevice::Atomic::Add(p_subcycle_counters,
+                                               static_cast<unsigned long long>(n_steps));
+                amrex::HostDevice::Atomic::Add(p_subcycle_counters + 1,
+                                               static_cast<unsigned long long>(i - i_start));
+            }
             if (enforceBC(ptd, ip, xp, yp, ux, uy, BeamIdx::w)) return;
             ptd.pos(0, ip) = xp;
             ptd.pos(1, ip) = yp;
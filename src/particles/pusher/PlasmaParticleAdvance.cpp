@@ -20,6 +20,7 @@
 #include "utils/DualNumbers.H"
 #include "particles/particles_utils/ParticleUtil.H"
 
+#include <optional>
 #include <string>
 
 // explicitly instantiate template to fix wrong warning with gcc
@@ -27,27 +28,42 @@ template struct PlasmaMomentumDerivative<amrex::Real>;
 template struct PlasmaMomentumDerivative<DualNumber>;
 
 void
-AdvancePlasmaParticles (PlasmaParticleContainer& plasma, const Fields & fields,
+AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
                         amrex::Vector<amrex::Geometry> const& gm, const bool temp_slice,
-                        int const lev)
+                        int const lev, const bool deposit_next_slice)
 {
     HIPACE_PROFILE("AdvancePlasmaParticles()");
     using namespace amrex::literals;
 
     const PhysConst phys_const = get_phys_const();
 
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!deposit_next_slice || (Hipace::m_explicit && !temp_slice &&
+        !Hipace::m_use_laser && !Hipace::m_deposit_rho_individual && lev == 0),
+        "The fused plasma push and deposition only works with the explicit solver, "
+        "without laser, rho individual deposition and mesh refinement");
+
     // Loop over particle boxes
     for (PlasmaParticleIterator pti(plasma); pti.isValid(); ++pti)
     {
         // Extract field array from FabArray
-        const amrex::FArrayBox& slice_fab = fields.getSlices(lev)[pti];
+        amrex::FArrayBox& slice_fab = fields.getSlices(lev)[pti];
         Array3<const amrex::Real> const slice_arr = slice_fab.const_array();
+        // the next slice is written to by the fused deposition, while slice_arr is only read
+        Array3<amrex::Real> const next_arr = slice_fab.array();
         const int psi_comp = Comps[WhichSlice::This]["Psi"];
         const int ez_comp = Comps[WhichSlice::This]["Ez"];
         const int bx_comp = Comps[WhichSlice::This]["Bx"];
         const int by_comp = Comps[WhichSlice::This]["By"];
         const int bz_comp = Comps[WhichSlice::This]["Bz"];
         const int aabs_comp = Hipace::m_use_laser ? Comps[WhichSlice::This]["aabs"] : -1;
+        // Do not access the Next components if the kernel does not deposit into them,
+        // they are only allocated for the fused push and deposition
+        const int jx_comp = deposit_next_slice ? Comps[WhichSlice::Next]["jx"] : -1;
+        const int jy_comp = deposit_next_slice ? Comps[WhichSlice::Next]["jy"] : -1;
+        const int chi_comp = deposit_next_slice ? Comps[WhichSlice::Next]["chi"] : -1;
+        const int rhomjz_comp = deposit_next_slice ? Comps[WhichSlice::Next]["rhomjz"] : -1;
+        const int rho_comp = deposit_next_slice && Hipace::m_deposit_rho ?
+            Comps[WhichSlice::Next]["rho"] : -1;
 
         // Extract properties associated with physical size of the box
         const amrex::Real dx_inv = gm[lev].InvCellSize(0);
@@ -79,17 +95,34 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, const Fields & fields,
         const amrex::Real clight_inv = 1._rt/phys_const.c;
         const amrex::Real charge_mass_clight_ratio = plasma.m_charge/(plasma.m_mass * phys_const.c);
 
+        // constants for the fused deposition, same as in DepositCurrent
+        const amrex::Real max_qsa_weighting_factor = plasma.m_max_qsa_weighting_factor;
+        const amrex::Real invvol = Hipace::m_normalized_units ?
+            gm[0].CellSize(0)*gm[0].CellSize(1)*dx_inv*dy_inv
+            : dx_inv*dy_inv*gm[lev].InvCellSize(2);
+        const amrex::Real charge_invvol = plasma.m_charge * invvol;
+        const amrex::Real charge_mu0_mass_ratio = plasma.m_charge * phys_const.mu0 / plasma.m_mass;
+
+        // only allocate the QSA violation counter if it is used
+        std::optional<amrex::Gpu::DeviceScalar<int>> gpu_n_qsa_violation;
+        if (deposit_next_slice) gpu_n_qsa_violation.emplace(0);
+        int* const AMREX_RESTRICT p_n_qsa_violation =
+            deposit_next_slice ? gpu_n_qsa_violation->dataPtr() : nullptr;
+
         // Use OMP ParallelFor to use multiple threads when running on CPU
         omp::ParallelFor(
             amrex::TypeList<
                 amrex::CompileTimeOptions<0, 1, 2, 3>,
+                amrex::CompileTimeOptions<false, true>,
                 amrex::CompileTimeOptions<false, true>
             >{}, {
                 Hipace::m_depos_order_xy,
-                Hipace::m_use_laser
+                Hipace::m_use_laser,
+                deposit_next_slice
             },
             int(pti.numParticles()), // int ParallelFor is 3-5% faster than amrex::Long version
-            [=] AMREX_GPU_DEVICE (int ip, auto depos_order, auto use_laser) {
+            [=] AMREX_GPU_DEVICE (int ip, auto depos_order, auto use_laser,
+                                  auto do_deposit) {
                 // only push plasma particles on their according MR level
                 if (!ptd.id(ip).is_valid() || ptd.cpu(ip) != lev) return;
 
@@ -269,8 +302,80 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, const Fields & fields,
                     ptd.rdata(PlasmaIdx::psi)[ip] = psi;
 #endif
                 } // loop over subcycles
+
+                if constexpr (do_deposit.value) {
+                    // Deposit the current of the pushed particle on the next slice while its
+                    // position and momentum are still in registers or the cache, instead of
+                    // reading them again in DepositCurrent. Laser is not supported, as aabs
+                    // of the next slice is not known yet.
+                    const amrex::Real psi_inv = 1._rt/ptd.rdata(PlasmaIdx::psi)[ip];
+                    const amrex::Real xp = ptd.pos(0, ip);
+                    const amrex::Real yp = ptd.pos(1, ip);
+                    const amrex::Real vx_c = ptd.rdata(PlasmaIdx::ux)[ip] * psi_inv;
+                    const amrex::Real vy_c = ptd.rdata(PlasmaIdx::uy)[ip] * psi_inv;
+
+                    amrex::Real q_invvol = charge_invvol * ptd.rdata(PlasmaIdx::w)[ip];
+                    amrex::Real q_mu0_mass_ratio = charge_mu0_mass_ratio;
+                    if (can_ionize) {
+                        q_invvol *= ptd.idata(PlasmaIdx::ion_lev)[ip];
+                        q_mu0_mass_ratio *= ptd.idata(PlasmaIdx::ion_lev)[ip];
+                    }
+
+                    // calculate gamma/psi for plasma particles
+                    const amrex::Real gamma_psi = 0.5_rt * (
+                        psi_inv * psi_inv
+                        + vx_c * vx_c * clight_inv * clight_inv
+                        + vy_c * vy_c * clight_inv * clight_inv
+                        + 1._rt
+                    );
+
+                    if (gamma_psi < 0.0_rt || gamma_psi > max_qsa_weighting_factor ||
+                        psi_inv < 0.0_rt)
+                    {
+                        // This particle violates the QSA, discard it and do not deposit its current
+                        amrex::Gpu::Atomic::Add(p_n_qsa_violation, 1);
+                        ptd.rdata(PlasmaIdx::w)[ip] = 0.0_rt;
+                        ptd.id(ip).make_invalid();
+                        return;
+                    }
+
+                    const amrex::Real xmid = (xp - x_pos_offset) * dx_inv;
+                    const amrex::Real ymid = (yp - y_pos_offset) * dy_inv;
+
+                    for (int iy=0; iy <= depos_order.value; ++iy) {
+                        for (int ix=0; ix <= depos_order.value; ++ix) {
+                            auto [shape_x, i] =
+                                compute_single_shape_factor<false, depos_order.value>(xmid, ix);
+                            auto [shape_y, j] =
+                                compute_single_shape_factor<false, depos_order.value>(ymid, iy);
+
+                            const amrex::Real charge_density = q_invvol * shape_x * shape_y;
+
+                            // multiple OMP threads can deposit into the same cell on CPU
+                            amrex::HostDevice::Atomic::Add(next_arr.ptr(i, j, jx_comp),
+                                                           charge_density * vx_c);
+                            amrex::HostDevice::Atomic::Add(next_arr.ptr(i, j, jy_comp),
+                                                           charge_density * vy_c);
+                            amrex::HostDevice::Atomic::Add(next_arr.ptr(i, j, chi_comp),
+                                charge_density * q_mu0_mass_ratio * psi_inv);
+                            amrex::HostDevice::Atomic::Add(next_arr.ptr(i, j, rhomjz_comp),
+                                                           charge_density);
+                            if (rho_comp != -1) {
+                                amrex::HostDevice::Atomic::Add(next_arr.ptr(i, j, rho_comp),
+                                                               charge_density * gamma_psi);
+                            }
+                        }
+                    }
+                }
             });
 
+        if (deposit_next_slice) {
+            const int n_qsa_violation = gpu_n_qsa_violation->dataValue();
+            if (n_qsa_violation > 0 && (Hipace::m_verbose >= 3))
+                amrex::Print()<< "number of QSA violating particles on this slice: " \
+                            << n_qsa_violation << "\n";
+        }
+
 #ifdef HIPACE_USE_AB5_PUSH
         if (!temp_slice) {
             auto& rd = pti.GetStructOfArrays().GetRealData();
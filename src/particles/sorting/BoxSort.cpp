@@ -11,7 +11,7 @@
 
 #include <AMReX_ParticleTransformation.H>
 
-void BoxSorter::sortParticlesByBox (const amrex::Real * z_array, const index_type num_particles,
+void BoxSorter::sortParticlesByBox (const amrex::ParticleReal * z_array, const index_type num_particles,
                                     const bool init_on_cpu, const amrex::Geometry& a_geom)
 {
     HIPACE_PROFILE("sortBeamParticlesByBox()");
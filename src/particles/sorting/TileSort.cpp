@@ -7,6 +7,7 @@
  */
 #include "TileSort.H"
 #include "utils/HipaceProfilerWrapper.H"
+#include "Hipace.H"
 
 #include <AMReX_ParticleTransformation.H>
 
@@ -54,6 +55,44 @@ findParticlesInEachTile (
     return bins;
 }
 
+PlasmaBins&
+findParticlesInEachCell (
+    amrex::Box bx, PlasmaParticleContainer& plasma, const amrex::Geometry& geom)
+{
+    HIPACE_PROFILE("findParticlesInEachCell()");
+
+    if (!Hipace::m_persistent_particle_bins) plasma.m_collision_bins.Invalidate();
+
+    const int lo_x = bx.smallEnd(0);
+    const int lo_y = bx.smallEnd(1);
+    const int nx = bx.length(0);
+    const int ny = bx.length(1);
+    const amrex::Real dxi = geom.InvCellSize(0);
+    const amrex::Real dyi = geom.InvCellSize(1);
+    const amrex::Real plo_x = geom.ProbLo(0);
+    const amrex::Real plo_y = geom.ProbLo(1);
+
+    auto get_bin = [=] AMREX_GPU_DEVICE (const auto& ptd, int ip) -> int {
+        const int ix = amrex::Clamp(static_cast<int>((ptd.pos(0, ip)-plo_x)*dxi-lo_x), 0, nx-1);
+        const int iy = amrex::Clamp(static_cast<int>((ptd.pos(1, ip)-plo_y)*dyi-lo_y), 0, ny-1);
+        return ix + iy * nx;
+    };
+
+    int count = 0; // number of boxes
+    for (PlasmaParticleIterator pti(plasma); pti.isValid(); ++pti) {
+        count += 1;
+        // collisions need the exact cell of every particle
+        plasma.m_collision_bins.Update(
+            int(pti.numParticles()), pti.GetParticleTile().getParticleTileData(), nx * ny,
+            {lo_x, lo_y, nx, ny}, get_bin,
+            [=] AMREX_GPU_DEVICE (const auto& ptd, int ip, int bin) {
+                return get_bin(ptd, ip) == bin;
+            });
+    }
+    AMREX_ALWAYS_ASSERT(count <= 1);
+    return plasma.m_collision_bins.Bins();
+}
+
 BeamBins
 findBeamParticlesInEachTile (
     amrex::Box bx, int bin_size,
@@ -93,3 +132,36 @@ findBeamParticlesInEachTile (
 
     return bins;
 }
+
+BeamBins
+findBeamParticlesInEachCell (
+    amrex::Box bx, BeamParticleContainer& beam, const amrex::Geometry& geom)
+{
+    HIPACE_PROFILE("findBeamParticlesInEachCell()");
+
+    const int lo_x = bx.smallEnd(0);
+    const int lo_y = bx.smallEnd(1);
+    const int nx = bx.length(0);
+    const int ny = bx.length(1);
+    const amrex::Real dxi = geom.InvCellSize(0);
+    const amrex::Real dyi = geom.InvCellSize(1);
+    const amrex::Real plo_x = geom.ProbLo(0);
+    const amrex::Real plo_y = geom.ProbLo(1);
+
+    BeamBins bins;
+
+    // same cell index as in findParticlesInEachCell
+    bins.build(
+        beam.getNumParticles(WhichBeamSlice::This),
+        beam.getBeamSlice(WhichBeamSlice::This).getParticleTileData(),
+        nx * ny,
+        [=] AMREX_GPU_DEVICE (const auto& ptd, int ip) -> int {
+            const int ix = amrex::Clamp(
+                static_cast<int>((ptd.pos(0, ip)-plo_x)*dxi-lo_x), 0, nx-1);
+            const int iy = amrex::Clamp(
+                static_cast<int>((ptd.pos(1, ip)-plo_y)*dyi-lo_y), 0, ny-1);
+            return ix + iy * nx;
+        });
+
+    return bins;
+}
@@ -10,6 +10,9 @@
 #include "utils/GPUUtil.H"
 #include "utils/HipaceProfilerWrapper.H"
 
+#include <algorithm>
+#include <limits>
+
 void
 SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last_islice,
               bool& overloaded, const int current_N_level, const int step, const int islice,
@@ -38,8 +41,18 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
                                         WhichSlice::This, {"Sy", "Sx"});
     }
 
+    // After the first iteration, the Ez fields can be solved on a sub-box around the SALAME beam
+    // using the full solution of the first iteration as boundary values
+    const bool try_sub_box = hipace->m_salame_sub_box_guard >= 0 && current_N_level == 1;
+    amrex::Box sub_box {};
+    // product of the weight factors applied to the SALAME beam since the full Ez solve
+    amrex::Real salame_scale = 1.;
+    amrex::Real W_prev = 1.;
+
     for (int iter=0; iter<n_iter; ++iter) {
 
+        const bool use_sub_box = iter > 0 && sub_box.ok();
+
         // STEP 1: Calculate what Ez would be with the initial SALAME beam weight
 
         for (int lev=0; lev<current_N_level; ++lev) {
@@ -60,32 +73,49 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
             hipace->m_multi_plasma.DepositCurrent(hipace->m_fields,
                     WhichSlice::Salame, true, false, false, false, false, hipace->m_3D_geom, lev);
 
-            // use an initial guess of zero for Bx and By in MG solver to reduce relative error
-            hipace->m_fields.setVal(0., lev, WhichSlice::Salame,
-                "Ez", "jz_beam", "Sy", "Sx", "Bx", "By");
+            if (use_sub_box) {
+                // Bx and By from the previous iteration are reused in STEP 2
+                hipace->m_fields.setVal(0., lev, WhichSlice::Salame, "Ez", "jz_beam", "Sy", "Sx");
+            } else {
+                // use an initial guess of zero for Bx and By in MG solver to reduce relative error
+                hipace->m_fields.setVal(0., lev, WhichSlice::Salame,
+                    "Ez", "jz_beam", "Sy", "Sx", "Bx", "By");
+            }
         }
 
-        hipace->m_fields.SolvePoissonEz(hipace->m_3D_geom, current_N_level, WhichSlice::Salame);
+        if (use_sub_box) {
+            // the boundary values are the ones of the full solve in the first iteration
+            hipace->m_fields.SolvePoissonEzSubBox(hipace->m_3D_geom[0], WhichSlice::Salame,
+                                                  sub_box, "Ez_no_salame", "Ez_no_salame", 1.);
+        } else {
+            hipace->m_fields.SolvePoissonEz(hipace->m_3D_geom, current_N_level, WhichSlice::Salame);
 
-        for (int lev=0; lev<current_N_level; ++lev) {
-            hipace->m_fields.duplicate(lev, WhichSlice::Salame, {"Ez_no_salame"},
-                                            WhichSlice::Salame, {"Ez"});
+            for (int lev=0; lev<current_N_level; ++lev) {
+                hipace->m_fields.duplicate(lev, WhichSlice::Salame, {"Ez_no_salame"},
+                                                WhichSlice::Salame, {"Ez"});
+            }
         }
 
         // STEP 2: Calculate the contribution to Ez from only the SALAME beam
 
-        for (int lev=0; lev<current_N_level; ++lev) {
-            // deposit SALAME beam jz
-            hipace->m_multi_beam.DepositCurrentSlice(hipace->m_fields, hipace->m_3D_geom, lev, step,
-                false, true, false, WhichSlice::Salame, WhichBeamSlice::This);
-        }
+        if (use_sub_box) {
+            // The SALAME beam particles did not move and chi is the same,
+            // so Bx and By from only the SALAME beam scale linearly with its weight
+            hipace->m_fields.mult(W_prev, 0, WhichSlice::Salame, "Bx", "By");
+        } else {
+            for (int lev=0; lev<current_N_level; ++lev) {
+                // deposit SALAME beam jz
+                hipace->m_multi_beam.DepositCurrentSlice(hipace->m_fields, hipace->m_3D_geom, lev,
+                    step, false, true, false, WhichSlice::Salame, WhichBeamSlice::This);
+            }
 
-        for (int lev=0; lev<current_N_level; ++lev) {
-            SalameInitializeSxSyWithBeam(hipace, lev);
-        }
+            for (int lev=0; lev<current_N_level; ++lev) {
+                SalameInitializeSxSyWithBeam(hipace, lev);
+            }
 
-        for (int lev=0; lev<current_N_level; ++lev) {
-            hipace->ExplicitMGSolveBxBy(lev, WhichSlice::Salame);
+            for (int lev=0; lev<current_N_level; ++lev) {
+                hipace->ExplicitMGSolveBxBy(lev, WhichSlice::Salame, islice);
+            }
         }
 
         for (int lev=0; lev<current_N_level; ++lev) {
@@ -118,7 +148,17 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
             }
         }
 
-        hipace->m_fields.SolvePoissonEz(hipace->m_3D_geom, current_N_level, WhichSlice::Salame);
+        if (use_sub_box) {
+            hipace->m_fields.SolvePoissonEzSubBox(hipace->m_3D_geom[0], WhichSlice::Salame,
+                                                  sub_box, "Ez", "Ez_only_salame", salame_scale);
+        } else {
+            hipace->m_fields.SolvePoissonEz(hipace->m_3D_geom, current_N_level, WhichSlice::Salame);
+
+            if (try_sub_box && iter == 0) {
+                hipace->m_fields.duplicate(0, WhichSlice::Salame, {"Ez_only_salame"},
+                                              WhichSlice::Salame, {"Ez"});
+            }
+        }
 
         // STEP 3: find ideal weighting factor of the SALAME beam using the computed Ez fields,
         // and update the beam with it
@@ -131,6 +171,10 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
                 false, true, false, WhichSlice::Salame, WhichBeamSlice::This, true);
         }
 
+        if (try_sub_box && iter == 0) {
+            sub_box = SalameGetSubBox(hipace, hipace->m_salame_sub_box_guard);
+        }
+
         // W = (Ez_target - Ez_no_salame) / Ez_only_salame + 1
         // + 1 because Ez_no_salame already includes the SALAME beam with a weight of 1
         // W_total = W * sum(jz)
@@ -156,6 +200,8 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
         amrex::Print() << '\n';
 
         SalameMultiplyBeamWeight(W, hipace);
+        salame_scale *= W;
+        W_prev = W;
 
         // STEP 4: recompute Bx and By with the new SALAME beam weight.
         // This is done a bit overkill by depositing again. A linear combination of the available
@@ -178,7 +224,7 @@ SalameModule (Hipace* hipace, const int n_iter, const bool do_advance, int& last
             hipace->m_fields.add(lev, WhichSlice::This, {"Sy", "Sx"},
                                     WhichSlice::Salame, {"Sy_back", "Sx_back"});
 
-            hipace->ExplicitMGSolveBxBy(lev, WhichSlice::This);
+            hipace->ExplicitMGSolveBxBy(lev, WhichSlice::This, islice);
         }
     }
 
@@ -338,6 +384,63 @@ SalameOnlyAdvancePlasma (Hipace* hipace, const int lev)
     }
 }
 
+amrex::Box
+SalameGetSubBox (Hipace* hipace, const int guard)
+{
+    // the SALAME beam current is only checked on level 0, as the sub-box is not used with MR
+    amrex::MultiFab& slicemf = hipace->m_fields.getSlices(0);
+    const amrex::Box slice_box = slicemf.boxArray()[0];
+
+    constexpr int int_max = std::numeric_limits<int>::max();
+    constexpr int int_min = std::numeric_limits<int>::lowest();
+    int lo_x = int_max, lo_y = int_max, hi_x = int_min, hi_y = int_min;
+
+    for ( amrex::MFIter mfi(slicemf, DfltMfiTlng); mfi.isValid(); ++mfi ){
+        amrex::ReduceOps<amrex::ReduceOpMin, amrex::ReduceOpMin,
+                         amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<int, int, int, int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        Array3<amrex::Real> const arr = slicemf.array(mfi);
+
+        const int jz = Comps[WhichSlice::Salame]["jz_beam"];
+
+        reduce_op.eval(mfi.tilebox(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int) noexcept -> ReduceTuple
+            {
+                if (arr(i,j,jz) == 0) return {int_max, int_max, int_min, int_min};
+                return {i, j, i, j};
+            });
+        auto res = reduce_data.value(reduce_op);
+        lo_x = std::min(lo_x, amrex::get<0>(res));
+        lo_y = std::min(lo_y, amrex::get<1>(res));
+        hi_x = std::max(hi_x, amrex::get<2>(res));
+        hi_y = std::max(hi_y, amrex::get<3>(res));
+    }
+
+    // no SALAME beam current on this slice
+    if (lo_x > hi_x || lo_y > hi_y) return amrex::Box{};
+
+    amrex::Box sub_box = slice_box;
+    sub_box.setSmall(0, lo_x - guard);
+    sub_box.setSmall(1, lo_y - guard);
+    sub_box.setBig(0, hi_x + guard);
+    sub_box.setBig(1, hi_y + guard);
+
+    // round up the size so that the FFT plans of the sub-box solver can be reused between slices
+    constexpr int size_multiple = 8;
+    for (int dir=0; dir<2; ++dir) {
+        sub_box.growHi(dir, (size_multiple - sub_box.length(dir) % size_multiple) % size_multiple);
+    }
+
+    // the boundary values around the sub-box have to be inside the slice,
+    // and cropping is only worth it if the sub-box is a lot smaller than the slice
+    if (!amrex::grow(slice_box, amrex::IntVect{-1, -1, 0}).contains(sub_box) ||
+        2 * sub_box.numPts() > slice_box.numPts()) {
+        return amrex::Box{};
+    }
+    return sub_box;
+}
+
 std::pair<amrex::Real, amrex::Real>
 SalameGetW (Hipace* hipace, const int current_N_level, const int islice)
 {
@@ -414,7 +517,7 @@ SalameMultiplyBeamWeight (const amrex::Real W, Hipace* hipace)
 
         // For id and weights
         auto& soa = beam.getBeamSlice(WhichBeamSlice::This).GetStructOfArrays();
-        amrex::Real * const wp = soa.GetRealData(BeamIdx::w).data();
+        amrex::ParticleReal * const wp = soa.GetRealData(BeamIdx::w).data();
         auto * const idcpup = soa.GetIdCPUData().data();
 
         amrex::ParallelFor(
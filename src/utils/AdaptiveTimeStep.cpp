@@ -13,6 +13,8 @@
 #include "HipaceProfilerWrapper.H"
 #include "Constants.H"
 
+#include <array>
+
 /** \brief describes which double is used for the adaptive time step */
 struct WhichDouble {
     enum Comp { MinUz=0, MinAcc, SumWeights, SumWeightsTimesUz, SumWeightsTimesUzSquared, N };
@@ -44,14 +46,39 @@ AdaptiveTimeStep::AdaptiveTimeStep (const int nbeams)
     m_timestep_data.resize(nbeams);
     for (int ibeam = 0; ibeam < nbeams; ibeam++) {
         m_timestep_data[ibeam].resize(WhichDouble::N);
+    }
+#ifdef AMREX_USE_GPU
+    m_timestep_data_device.resize(nbeams * WhichDouble::N);
+#endif
+
+    m_nbeams = nbeams;
+    ResetTimeStepData();
+}
+
+void
+AdaptiveTimeStep::ResetTimeStepData ()
+{
+    for (int ibeam = 0; ibeam < m_nbeams; ibeam++) {
         m_timestep_data[ibeam][WhichDouble::MinUz] = 1e30;
         m_timestep_data[ibeam][WhichDouble::MinAcc] = 0.;
         m_timestep_data[ibeam][WhichDouble::SumWeights] = 0.;
         m_timestep_data[ibeam][WhichDouble::SumWeightsTimesUz] = 0.;
         m_timestep_data[ibeam][WhichDouble::SumWeightsTimesUzSquared] = 0.;
     }
+    ResetDeviceTimeStepData();
+}
 
-    m_nbeams = nbeams;
+void
+AdaptiveTimeStep::ResetDeviceTimeStepData ()
+{
+#ifdef AMREX_USE_GPU
+    amrex::Vector<double> h_data(m_timestep_data_device.size(), 0.);
+    for (int ibeam = 0; ibeam < m_nbeams; ibeam++) {
+        h_data[ibeam*WhichDouble::N + WhichDouble::MinUz] = 1e30;
+    }
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice, h_data.begin(), h_data.end(),
+                     m_timestep_data_device.begin());
+#endif
 }
 
 
@@ -110,8 +137,8 @@ AdaptiveTimeStep::GatherMinUzSlice (MultiBeam& beams, const bool initial)
         }
 
         unsigned long long num_particles = 0;
-        const amrex::Real * uzp = nullptr;
-        const amrex::Real * wp = nullptr;
+        const amrex::ParticleReal * uzp = nullptr;
+        const amrex::ParticleReal * wp = nullptr;
         const std::uint64_t * idcpup = nullptr;
 
         // Extract particle properties
@@ -130,6 +157,31 @@ AdaptiveTimeStep::GatherMinUzSlice (MultiBeam& beams, const bool initial)
             idcpup = soa.GetIdCPUData().data();
         }
 
+#ifdef AMREX_USE_GPU
+        if (!initial) {
+            // accumulate on the device without synchronizing,
+            // the result is only needed in CalculateFromMinUz after the last slice
+            double* const AMREX_RESTRICT p_data =
+                m_timestep_data_device.dataPtr() + ibeam*WhichDouble::N;
+            amrex::ParallelFor(amrex::Gpu::KernelInfo().setReduction(true), num_particles,
+                [=] AMREX_GPU_DEVICE (unsigned long long ip,
+                                      amrex::Gpu::Handler const& handler) noexcept
+                {
+                    const bool valid = amrex::ConstParticleIDWrapper(idcpup[ip]) >= 0;
+                    const double w = valid ? wp[ip] : 0.;
+                    const double uz = uzp[ip] * clightinv;
+                    amrex::Gpu::deviceReduceSum(p_data + WhichDouble::SumWeights, w, handler);
+                    amrex::Gpu::deviceReduceSum(p_data + WhichDouble::SumWeightsTimesUz,
+                                                w * uz, handler);
+                    amrex::Gpu::deviceReduceSum(p_data + WhichDouble::SumWeightsTimesUzSquared,
+                                                w * uz * uz, handler);
+                    amrex::Gpu::deviceReduceMin(p_data + WhichDouble::MinUz,
+                        valid ? uz : std::numeric_limits<double>::infinity(), handler);
+                });
+            continue;
+        }
+#endif
+
         amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum,
                          amrex::ReduceOpSum, amrex::ReduceOpMin> reduce_op;
         amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real, amrex::Real>
@@ -179,6 +231,25 @@ AdaptiveTimeStep::CalculateFromMinUz (
         "Must have at least one beam to use adaptive time step");
     const int numprocs = Hipace::m_numprocs;
 
+#ifdef AMREX_USE_GPU
+    // add the values accumulated on the device during the step, with a single synchronization
+    amrex::Vector<double> h_data(m_timestep_data_device.size());
+    amrex::Gpu::copy(amrex::Gpu::deviceToHost, m_timestep_data_device.begin(),
+                     m_timestep_data_device.end(), h_data.begin());
+    for (int ibeam = 0; ibeam < nbeams; ibeam++) {
+        const double* const d = h_data.data() + ibeam*WhichDouble::N;
+        auto& data = m_timestep_data[ibeam];
+        data[WhichDouble::MinUz] = std::min<amrex::Real>(data[WhichDouble::MinUz],
+                                                         d[WhichDouble::MinUz]);
+        data[WhichDouble::MinAcc] = std::min<amrex::Real>(data[WhichDouble::MinAcc],
+                                                          d[WhichDouble::MinAcc]);
+        data[WhichDouble::SumWeights] += d[WhichDouble::SumWeights];
+        data[WhichDouble::SumWeightsTimesUz] += d[WhichDouble::SumWeightsTimesUz];
+        data[WhichDouble::SumWeightsTimesUzSquared] += d[WhichDouble::SumWeightsTimesUzSquared];
+    }
+    ResetDeviceTimeStepData();
+#endif
+
     amrex::Vector<amrex::Real> new_dts;
     new_dts.resize(nbeams);
     amrex::Vector<amrex::Real> beams_min_uz_mq;
@@ -281,10 +352,6 @@ AdaptiveTimeStep::GatherMinAccSlice (MultiBeam& beams, const amrex::Geometry& ge
         const auto& beam = beams.getBeam(ibeam);
         const amrex::Real charge_mass_ratio = beam.m_charge / beam.m_mass;
 
-        amrex::ReduceOps<amrex::ReduceOpMin> reduce_op;
-        amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
-        using ReduceTuple = typename decltype(reduce_data)::Type;
-
         // Data required to gather the Ez field
         const amrex::FArrayBox& slice_fab = fields.getSlices(lev)[0];
         Array3<const amrex::Real> const slice_arr = slice_fab.const_array();
@@ -299,6 +366,29 @@ AdaptiveTimeStep::GatherMinAccSlice (MultiBeam& beams, const amrex::Geometry& ge
         const auto pos_y = soa.GetRealData(BeamIdx::y).data();
         const auto idcpup = soa.GetIdCPUData().data();
 
+#ifdef AMREX_USE_GPU
+        // accumulate on the device without synchronizing,
+        // the result is only needed in CalculateFromMinUz after the last slice
+        double* const AMREX_RESTRICT p_min_acc =
+            m_timestep_data_device.dataPtr() + ibeam*WhichDouble::N + WhichDouble::MinAcc;
+        amrex::ParallelFor(amrex::Gpu::KernelInfo().setReduction(true),
+            beam.getNumParticles(WhichBeamSlice::This),
+            [=] AMREX_GPU_DEVICE (long ip, amrex::Gpu::Handler const& handler) noexcept
+            {
+                amrex::Real acc = 0._rt;
+                if (amrex::ConstParticleIDWrapper(idcpup[ip]) >= 0) {
+                    amrex::Real Ezp = 0._rt;
+                    doGatherEz(pos_x[ip], pos_y[ip], Ezp, slice_arr, ez_comp,
+                               dx_inv, dy_inv, x_pos_offset, y_pos_offset);
+                    acc = charge_mass_ratio * Ezp * clightinv;
+                }
+                amrex::Gpu::deviceReduceMin(p_min_acc, double(acc), handler);
+            });
+#else
+        amrex::ReduceOps<amrex::ReduceOpMin> reduce_op;
+        amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
         reduce_op.eval(beam.getNumParticles(WhichBeamSlice::This), reduce_data,
             [=] AMREX_GPU_DEVICE (long ip) noexcept -> ReduceTuple
             {
@@ -317,6 +407,7 @@ AdaptiveTimeStep::GatherMinAccSlice (MultiBeam& beams, const amrex::Geometry& ge
         auto res = reduce_data.value(reduce_op);
         m_timestep_data[ibeam][WhichDouble::MinAcc] =
             std::min(m_timestep_data[ibeam][WhichDouble::MinAcc], amrex::get<0>(res));
+#endif
     }
 }
 
@@ -327,13 +418,7 @@ AdaptiveTimeStep::CalculateFromDensity (amrex::Real t, amrex::Real& dt, MultiPla
 
     if (!m_do_adaptive_time_step) return;
 
-    for (int ibeam = 0; ibeam < m_nbeams; ibeam++) {
-        m_timestep_data[ibeam][WhichDouble::MinUz] = 1e30;
-        m_timestep_data[ibeam][WhichDouble::MinAcc] = 0.;
-        m_timestep_data[ibeam][WhichDouble::SumWeights] = 0.;
-        m_timestep_data[ibeam][WhichDouble::SumWeightsTimesUz] = 0.;
-        m_timestep_data[ibeam][WhichDouble::SumWeightsTimesUzSquared] = 0.;
-    }
+    ResetTimeStepData();
 
     if (!m_adaptive_control_phase_advance) return;
 
@@ -367,3 +452,27 @@ AdaptiveTimeStep::CalculateFromDensity (amrex::Real t, amrex::Real& dt, MultiPla
         }
     }
 }
+
+void
+AdaptiveTimeStep::ReportBeamSubcycles (MultiBeam& beams, const int step)
+{
+    for (int ibeam = 0; ibeam < beams.get_nbeams(); ibeam++) {
+        auto& beam = beams.getBeam(ibeam);
+        if (!beam.m_adaptive_subcycling) continue;
+
+        std::array<unsigned long long, 2> counters {0, 0};
+        amrex::Gpu::copy(amrex::Gpu::deviceToHost, beam.m_subcycle_counters.begin(),
+                         beam.m_subcycle_counters.end(), counters.begin());
+        const std::array<unsigned long long, 2> zeros {0, 0};
+        amrex::Gpu::copy(amrex::Gpu::hostToDevice, zeros.begin(), zeros.end(),
+                         beam.m_subcycle_counters.begin());
+
+        // number of full pushes (all n_subcycles) done in this step
+        const double num_pushes = double(counters[1]) / beam.m_n_subcycles;
+        if (num_pushes == 0.) continue;
+        amrex::AllPrint() << "Rank " << amrex::ParallelDescriptor::MyProc() << ": beam "
+                          << beam.get_name() << " used on average "
+                          << counters[0] / num_pushes << " of " << beam.m_n_subcycles
+                          << " sub-cycles per particle in step " << step << "\n";
+    }
+}
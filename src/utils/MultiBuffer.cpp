@@ -10,19 +10,105 @@
 #include "HipaceProfilerWrapper.H"
 #include "Parser.H"
 
+#include <AMReX_IOFormat.H>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+    /** \brief convert a float to the bits of an IEEE half precision number,
+     * rounding to nearest even. The values are expected to be in [-1, 1]. */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    std::uint16_t float_to_half (float value) {
+        std::uint32_t x = 0;
+        std::memcpy(&x, &value, sizeof(float));
+        const std::uint32_t sign = (x >> 16) & 0x8000u;
+        const int exponent = static_cast<int>((x >> 23) & 0xffu) - 127 + 15;
+        std::uint32_t mantissa = x & 0x7fffffu;
+        if (exponent <= 0) {
+            // subnormal half or zero
+            if (exponent < -10) return static_cast<std::uint16_t>(sign);
+            mantissa |= 0x800000u;
+            const int shift = 14 - exponent;
+            std::uint32_t h = mantissa >> shift;
+            const std::uint32_t rest = mantissa & ((1u << shift) - 1u);
+            const std::uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (h & 1u))) ++h;
+            return static_cast<std::uint16_t>(sign | h);
+        }
+        if (exponent >= 31) {
+            // overflow or nan
+            return static_cast<std::uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+        }
+        std::uint32_t h = (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+        const std::uint32_t rest = mantissa & 0x1fffu;
+        if (rest > 0x1000u || (rest == 0x1000u && (h & 1u))) ++h;
+        return static_cast<std::uint16_t>(sign | h);
+    }
+
+    /** \brief convert the bits of an IEEE half precision number to a float */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    float half_to_float (std::uint16_t h) {
+        const std::uint32_t sign = (static_cast<std::uint32_t>(h) & 0x8000u) << 16;
+        const std::uint32_t exponent = (h >> 10) & 0x1fu;
+        const std::uint32_t mantissa = h & 0x3ffu;
+        if (exponent == 0) {
+            // subnormal half or zero
+            const float value = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+            return sign ? -value : value;
+        }
+        std::uint32_t x = 0;
+        if (exponent == 31) {
+            x = sign | 0x7f800000u | (mantissa << 13);
+        } else {
+            x = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+        }
+        float value = 0.f;
+        std::memcpy(&value, &x, sizeof(float));
+        return value;
+    }
+}
 
 std::size_t MultiBuffer::get_metadata_size () {
     // 0: buffer size
     // 1: number of particles for beam 0
     // 2: number of particles for beam 1
     // ...
-    return 1 + m_nbeams;
+    // 1 + nbeams: bitmask of the components stored in single or half precision
+    // 2 + nbeams: scale of the laser stored in half precision, as bits of a double
+    return 3 + m_nbeams;
 }
 
 std::size_t* MultiBuffer::get_metadata_location (int slice) {
     return m_metadata.dataPtr() + slice*get_metadata_size();
 }
 
+bool MultiBuffer::is_fp32_in_buffer (int slice, int bit) {
+    return (get_metadata_location(slice)[1 + m_nbeams] >> bit) & 1;
+}
+
+bool MultiBuffer::is_fp16_laser_in_buffer (int slice) {
+    return (get_metadata_location(slice)[1 + m_nbeams] >> laser_fp16_bit) & 1;
+}
+
+double MultiBuffer::get_laser_scale_in_buffer (int slice) {
+    double scale = 1.;
+    std::memcpy(&scale, get_metadata_location(slice) + 2 + m_nbeams, sizeof(double));
+    return scale;
+}
+
+std::size_t MultiBuffer::get_real_size_in_buffer (int slice, int bit) {
+    if (bit == laser_fp32_bit && is_fp16_laser_in_buffer(slice)) return sizeof(std::uint16_t);
+    if (is_fp32_in_buffer(slice, bit)) return sizeof(float);
+    // the laser is stored in amrex::Real, beam components in amrex::ParticleReal
+    return bit == laser_fp32_bit ? sizeof(amrex::Real) : sizeof(amrex::ParticleReal);
+}
+
 void MultiBuffer::allocate_buffer (int slice) {
     AMREX_ALWAYS_ASSERT(m_datanodes[slice].m_location == memory_location::nowhere);
     if (!m_buffer_on_gpu) {
@@ -37,6 +123,7 @@ void MultiBuffer::allocate_buffer (int slice) {
         m_datanodes[slice].m_location = memory_location::device;
     }
     m_current_buffer_size += m_datanodes[slice].m_buffer_size * sizeof(storage_type);
+    m_peak_buffer_size = std::max(m_peak_buffer_size, m_current_buffer_size);
 }
 
 void MultiBuffer::free_buffer (int slice) {
@@ -74,7 +161,27 @@ void MultiBuffer::initialize (int nslices, MultiBeam& beams, MultiLaser& laser)
     m_tag_metadata_start = m_tag_buffer_start + m_nslices;
 
     queryWithParser(pp, "on_gpu", m_buffer_on_gpu);
+    queryWithParser(pp, "adaptive_depth", m_adaptive_depth);
+    queryWithParser(pp, "adaptive_stall_fraction", m_adaptive_stall_fraction);
+    if (Hipace::m_max_step >= n_ranks) {
+        // every slice has to be stored on some rank
+        m_min_trailing_slices = nslices / n_ranks + 1;
+    }
+    if (m_adaptive_depth) {
+        // start with small windows, they are increased if the communication is too slow
+        m_max_leading_slices = 2;
+        m_max_trailing_slices = std::max(2, m_min_trailing_slices);
+    }
     queryWithParser(pp, "max_leading_slices", m_max_leading_slices);
+    queryWithParser(pp, "trace", m_trace);
+    queryWithParser(pp, "trace_file", m_trace_file);
+    if (m_trace) {
+        m_trace_index.resize(m_nslices, -1);
+        m_trace_recv_ready.resize(m_nslices, -1.);
+        // all ranks measure the time relative to this point
+        amrex::ParallelDescriptor::Barrier();
+        m_trace_start_time = amrex::second();
+    }
     queryWithParser(pp, "max_trailing_slices", m_max_trailing_slices);
 #ifdef AMREX_USE_GPU
     queryWithParser(pp, "async_memcpy", m_async_memcpy);
@@ -84,6 +191,49 @@ void MultiBuffer::initialize (int nslices, MultiBeam& beams, MultiLaser& laser)
         m_async_memcpy = false;
     }
 
+    // components that are converted to single precision before they are communicated
+    std::vector<std::string> fp32_beam_components {};
+    queryWithParser(pp, "fp32_beam_components", fp32_beam_components);
+    const std::map<std::string, int> beam_component_names {
+        {"x", BeamIdx::x}, {"y", BeamIdx::y}, {"z", BeamIdx::z}, {"w", BeamIdx::w},
+        {"ux", BeamIdx::ux}, {"uy", BeamIdx::uy}, {"uz", BeamIdx::uz},
+        {"sx", BeamIdx::real_nattribs}, {"sy", BeamIdx::real_nattribs + 1},
+        {"sz", BeamIdx::real_nattribs + 2}
+    };
+    for (const auto& name : fp32_beam_components) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(beam_component_names.count(name) == 1,
+            "Unknown beam component '" + name + "' in comms_buffer.fp32_beam_components, "
+            "must be one of x y z w ux uy uz sx sy sz");
+        m_fp32_mask |= std::size_t(1) << beam_component_names.at(name);
+    }
+    bool fp32_laser = false;
+    queryWithParser(pp, "fp32_laser", fp32_laser);
+    bool fp16_laser = false;
+    queryWithParser(pp, "fp16_laser", fp16_laser);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(fp32_laser && fp16_laser),
+        "comms_buffer.fp32_laser and comms_buffer.fp16_laser cannot be used at the same time");
+    if (fp32_laser) {
+        m_fp32_mask |= std::size_t(1) << laser_fp32_bit;
+    }
+    if (fp16_laser) {
+        m_fp32_mask |= std::size_t(1) << laser_fp16_bit;
+    }
+    if (sizeof(amrex::ParticleReal) <= sizeof(float)) {
+        // nothing to do for beams with single precision particles
+        m_fp32_mask &= (std::size_t(1) << laser_fp32_bit) | (std::size_t(1) << laser_fp16_bit);
+    }
+    if (sizeof(amrex::Real) <= sizeof(float)) {
+        // nothing to do for the laser in single precision
+        m_fp32_mask &= ~(std::size_t(1) << laser_fp32_bit);
+    }
+    auto bytes_per_real = [&] (int bit) {
+        if (bit == laser_fp32_bit && ((m_fp32_mask >> laser_fp16_bit) & 1)) {
+            return sizeof(std::uint16_t);
+        }
+        if ((m_fp32_mask >> bit) & 1) return sizeof(float);
+        return bit == laser_fp32_bit ? sizeof(amrex::Real) : sizeof(amrex::ParticleReal);
+    };
+
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
         ((double(m_max_trailing_slices) * n_ranks) > nslices)
         || (Hipace::m_max_step < amrex::ParallelDescriptor::NProcs()),
@@ -106,7 +256,7 @@ void MultiBuffer::initialize (int nslices, MultiBeam& beams, MultiLaser& laser)
 
             for (int rcomp = 0; rcomp < beam.numRealComponents(); ++rcomp) {
                 if (beam.communicateRealComponent(rcomp)) {
-                    size_estimate += num_particles * sizeof(amrex::Real);
+                    size_estimate += num_particles * bytes_per_real(rcomp);
                 }
             }
 
@@ -119,7 +269,7 @@ void MultiBuffer::initialize (int nslices, MultiBeam& beams, MultiLaser& laser)
 
         if (laser.UseLaser()) {
             size_estimate += laser.GetLaserGeom().Domain().numPts()
-                * m_laser_ncomp * sizeof(amrex::Real);
+                * m_laser_ncomp * bytes_per_real(laser_fp32_bit);
         }
 
         size_estimate /= 1024*1024*1024;
@@ -284,6 +434,43 @@ MultiBuffer::~MultiBuffer () {
 #endif
 }
 
+void MultiBuffer::make_blocking_recv_progress (int slice, int current_slice) {
+    // the first slice has to wait for the previous rank to start its time step,
+    // this is not caused by the size of the leading window
+    const bool measure = m_adaptive_depth && slice != m_nslices - 1;
+    const double start_time = measure ? amrex::second() : 0.;
+    make_progress(slice, true, current_slice);
+    if (measure) {
+        m_recv_stall_time += amrex::second() - start_time;
+    }
+}
+
+void MultiBuffer::adapt_depth () {
+    const double step_time = amrex::second() - m_step_start_time;
+    if (step_time <= 0.) return;
+
+    // only grow the windows if this does not exceed the memory cap
+    const bool can_grow = m_peak_buffer_size < m_max_buffer_size;
+    const double grow_threshold = m_adaptive_stall_fraction * step_time;
+    const double shrink_threshold = 0.25 * m_adaptive_stall_fraction * step_time;
+
+    if (m_recv_stall_time > grow_threshold && can_grow) {
+        m_max_leading_slices = std::min(2 * m_max_leading_slices, m_nslices);
+    } else if (m_recv_stall_time < shrink_threshold) {
+        m_max_leading_slices = std::max(3 * m_max_leading_slices / 4, 1);
+    }
+
+    if (m_send_stall_time > grow_threshold && can_grow) {
+        m_max_trailing_slices = std::min(2 * m_max_trailing_slices, m_nslices);
+    } else if (m_send_stall_time < shrink_threshold) {
+        m_max_trailing_slices = std::max(3 * m_max_trailing_slices / 4, m_min_trailing_slices);
+    }
+
+    m_recv_stall_time = 0.;
+    m_send_stall_time = 0.;
+    m_peak_buffer_size = m_current_buffer_size;
+}
+
 void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice) {
     const bool is_first_slice_with_recv_data =
         m_async_data_slice[comm_progress::receive_started] == slice;
@@ -292,6 +479,9 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
     const bool is_blocking_send = is_blocking ||
         ((m_nslices + slice - current_slice) % m_nslices > m_max_trailing_slices) ||
         (is_last_slice_with_send_data && (m_current_buffer_size > m_max_buffer_size));
+    // time spent in blocking sends that are caused by a full trailing window or buffer
+    const bool measure_send_stall = m_adaptive_depth && is_blocking_send && !is_blocking;
+    const double send_stall_start_time = measure_send_stall ? amrex::second() : 0.;
     const bool is_blocking_recv = is_blocking;
     const bool skip_recv = !is_blocking_recv && (slice == current_slice ||
         (m_nslices - slice + current_slice) % m_nslices > m_max_leading_slices);
@@ -303,6 +493,7 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
             AMREX_ALWAYS_ASSERT(m_datanodes[slice].m_progress == comm_progress::ready_to_send);
             m_datanodes[slice].m_metadata_progress = comm_progress::received;
             m_datanodes[slice].m_progress = comm_progress::received;
+            trace_received(slice);
         }
         return;
     }
@@ -325,6 +516,7 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
         if (m_datanodes[slice].m_buffer_size == 0) {
             // don't send empty buffer
             m_datanodes[slice].m_progress = comm_progress::sent;
+            trace_sent(slice);
         } else {
             MPI_Isend(
                 m_datanodes[slice].m_buffer,
@@ -381,12 +573,14 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
             MPI_Wait(&(m_datanodes[slice].m_request), MPI_STATUS_IGNORE);
             free_buffer(slice);
             m_datanodes[slice].m_progress = comm_progress::sent;
+            trace_sent(slice);
         } else {
             int is_complete = false;
             MPI_Test(&(m_datanodes[slice].m_request), &is_complete, MPI_STATUS_IGNORE);
             if (is_complete) {
                 free_buffer(slice);
                 m_datanodes[slice].m_progress = comm_progress::sent;
+                trace_sent(slice);
             }
         }
     }
@@ -401,6 +595,7 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
         if (m_datanodes[slice].m_buffer_size == 0) {
             // don't receive empty buffer
             m_datanodes[slice].m_progress = comm_progress::received;
+            trace_received(slice);
         } else {
             // enforce that slices are received in order
             if (is_blocking_recv || (is_first_slice_with_recv_data &&
@@ -424,11 +619,13 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
         if (is_blocking_recv) {
             MPI_Wait(&(m_datanodes[slice].m_request), MPI_STATUS_IGNORE);
             m_datanodes[slice].m_progress = comm_progress::received;
+            trace_received(slice);
         } else {
             int is_complete = false;
             MPI_Test(&(m_datanodes[slice].m_request), &is_complete, MPI_STATUS_IGNORE);
             if (is_complete) {
                 m_datanodes[slice].m_progress = comm_progress::received;
+                trace_received(slice);
             }
         }
     }
@@ -438,11 +635,28 @@ void MultiBuffer::make_progress (int slice, bool is_blocking, int current_slice)
         AMREX_ALWAYS_ASSERT(m_datanodes[slice].m_progress == comm_progress::received);
     }
 
+    if (measure_send_stall) {
+        m_send_stall_time += amrex::second() - send_stall_start_time;
+    }
+
 #endif
 }
 
 void MultiBuffer::get_data (int slice, MultiBeam& beams, MultiLaser& laser, int beam_slice) {
     HIPACE_PROFILE("MultiBuffer::get_data()");
+    if (slice == m_nslices - 1) {
+        m_step_start_time = amrex::second();
+    }
+    if (m_trace) {
+        if (slice == m_nslices - 1) {
+            ++m_trace_nsteps;
+        }
+        m_trace_index[slice] = static_cast<int>(m_trace_data.size());
+        m_trace_data.emplace_back();
+        m_trace_data.back().m_step = m_trace_nsteps - 1;
+        m_trace_data.back().m_slice = slice;
+        m_trace_data.back().m_get_begin = amrex::second() - m_trace_start_time;
+    }
     if (m_datanodes[slice].m_progress == comm_progress::ready_to_define) {
         // initialize MultiBeam and MultiLaser per slice on the first timestep
         for (int b = 0; b < m_nbeams; ++b) {
@@ -458,7 +672,7 @@ void MultiBuffer::get_data (int slice, MultiBeam& beams, MultiLaser& laser, int
         if (m_async_memcpy) {
             if (slice == m_nslices - 1) {
                 // receive fist slice
-                make_progress(slice, true, slice);
+                make_blocking_recv_progress(slice, slice);
                 if (m_datanodes[slice].m_buffer_size != 0) {
                     async_memcpy_from_buffer(slice);
                 }
@@ -472,13 +686,13 @@ void MultiBuffer::get_data (int slice, MultiBeam& beams, MultiLaser& laser, int
 
             if (slice > 0) {
                 // receive next slice and start async memcpy
-                make_progress(slice-1, true, slice);
+                make_blocking_recv_progress(slice-1, slice);
                 if (m_datanodes[slice-1].m_buffer_size != 0) {
                     async_memcpy_from_buffer(slice-1);
                 }
             }
         } else {
-            make_progress(slice, true, slice);
+            make_blocking_recv_progress(slice, slice);
             if (m_datanodes[slice].m_buffer_size != 0) {
                 unpack_data(slice, beams, laser, beam_slice);
                 free_buffer(slice);
@@ -487,11 +701,22 @@ void MultiBuffer::get_data (int slice, MultiBeam& beams, MultiLaser& laser, int
     }
     m_datanodes[slice].m_progress = comm_progress::in_use;
     m_datanodes[slice].m_metadata_progress = comm_progress::in_use;
+    if (m_trace) {
+        SliceTrace& trace = m_trace_data[m_trace_index[slice]];
+        trace.m_get_end = amrex::second() - m_trace_start_time;
+        // slices initialized on the head rank are ready immediately
+        trace.m_recv_ready = m_trace_recv_ready[slice] >= 0. ?
+            m_trace_recv_ready[slice] : trace.m_get_begin;
+        m_trace_recv_ready[slice] = -1.;
+    }
 }
 
 void MultiBuffer::put_data (int slice, MultiBeam& beams, MultiLaser& laser, int beam_slice,
                             bool is_last_time_step) {
     HIPACE_PROFILE("MultiBuffer::put_data()");
+    if (m_trace) {
+        m_trace_data[m_trace_index[slice]].m_put_begin = amrex::second() - m_trace_start_time;
+    }
     if (is_last_time_step) {
         // don't send buffer on the last step
         m_datanodes[slice].m_progress = comm_progress::sim_completed;
@@ -606,6 +831,146 @@ void MultiBuffer::put_data (int slice, MultiBeam& beams, MultiLaser& laser, int
             }
         }
     }
+
+    if (m_adaptive_depth && slice == 0 && !m_is_serial) {
+        // last slice of the time step
+        adapt_depth();
+    }
+
+    if (m_trace) {
+        m_trace_data[m_trace_index[slice]].m_put_end = amrex::second() - m_trace_start_time;
+    }
+}
+
+void MultiBuffer::trace_received (int slice) {
+    if (m_trace) {
+        m_trace_recv_ready[slice] = amrex::second() - m_trace_start_time;
+    }
+}
+
+void MultiBuffer::trace_sent (int slice) {
+    if (m_trace && m_trace_index[slice] >= 0) {
+        m_trace_data[m_trace_index[slice]].m_send_complete = amrex::second() - m_trace_start_time;
+    }
+}
+
+void MultiBuffer::write_trace () {
+    if (!m_trace) return;
+    HIPACE_PROFILE("MultiBuffer::write_trace()");
+
+    const int rank_id = amrex::ParallelDescriptor::MyProc();
+    const int n_ranks = amrex::ParallelDescriptor::NProcs();
+    const double end_time = amrex::second() - m_trace_start_time;
+
+    // The computation of a slice starts when the previous slice was sent off
+    // (or the first slice was received) and ends when the slice is sent.
+    // The time spent blocking to receive the next slice during that time is not computation.
+    enum trace_stat : int {
+        compute_time, recv_wait_time, first_start, last_end, wall_time, nstats
+    };
+    std::array<double, nstats> local_stats {0., 0., end_time, 0., end_time};
+    double compute_start = 0.;
+    for (const auto& trace : m_trace_data) {
+        const double wait_time = trace.m_get_end - trace.m_get_begin;
+        local_stats[trace_stat::recv_wait_time] += wait_time;
+        if (trace.m_slice == m_nslices - 1) {
+            compute_start = trace.m_get_end;
+            local_stats[trace_stat::first_start] =
+                std::min(local_stats[trace_stat::first_start], compute_start);
+        } else {
+            // the receive of this slice happened during the computation of the previous one
+            local_stats[trace_stat::compute_time] -= wait_time;
+        }
+        if (trace.m_put_begin >= 0.) {
+            local_stats[trace_stat::compute_time] += trace.m_put_begin - compute_start;
+            local_stats[trace_stat::last_end] =
+                std::max(local_stats[trace_stat::last_end], trace.m_put_begin);
+            compute_start = trace.m_put_end;
+        }
+    }
+
+    std::vector<double> all_stats(std::size_t(nstats) * n_ranks, 0.);
+    amrex::ParallelDescriptor::Gather(local_stats.data(), nstats, all_stats.data(),
+                                      amrex::ParallelDescriptor::IOProcessorNumber());
+
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+        auto stats = [&] (int r, int comp) { return all_stats[r*nstats + comp]; };
+        double total_compute = 0.;
+        double total_start_bubble = 0.;
+        double total_end_bubble = 0.;
+        double max_wall = 0.;
+        int critical_rank = 0;
+        for (int r = 0; r < n_ranks; ++r) {
+            max_wall = std::max(max_wall, stats(r, trace_stat::wall_time));
+        }
+        for (int r = 0; r < n_ranks; ++r) {
+            total_compute += stats(r, trace_stat::compute_time);
+            total_start_bubble += stats(r, trace_stat::first_start);
+            total_end_bubble += max_wall - stats(r, trace_stat::last_end);
+            if (stats(r, trace_stat::compute_time) >
+                stats(critical_rank, trace_stat::compute_time)) {
+                critical_rank = r;
+            }
+        }
+
+        amrex::IOFormatSaver iofmtsaver(std::cout);
+        std::cout << std::setprecision(4)
+                  << "Pipeline trace over " << n_ranks << (n_ranks > 1 ? " ranks" : " rank")
+                  << " and " << max_wall << " seconds:\n"
+                  << "  pipeline efficiency: "
+                  << (max_wall > 0. ? 100. * total_compute / (max_wall * n_ranks) : 0.) << " %\n"
+                  << "  critical rank: " << critical_rank << " with "
+                  << stats(critical_rank, trace_stat::compute_time) << " seconds of computation, "
+                  << stats(critical_rank, trace_stat::recv_wait_time)
+                  << " seconds waiting to receive\n"
+                  << "  bubble time at the start: " << total_start_bubble / n_ranks
+                  << " seconds per rank, at the end: " << total_end_bubble / n_ranks
+                  << " seconds per rank" << std::endl;
+    }
+
+    if (m_trace_file.empty()) return;
+
+    // all ranks append their events to the same file one after another
+    for (int r = 0; r < n_ranks; ++r) {
+        if (r == rank_id) {
+            std::ofstream ofs{m_trace_file, r == 0 ? std::ofstream::out : std::ofstream::app};
+            ofs << std::setprecision(15);
+            ofs << (r == 0 ? "[\n" : ",\n")
+                << R"({"name":"process_name","ph":"M","pid":)" << r
+                << R"(,"args":{"name":"rank )" << r << R"("}})";
+            // Chrome trace timestamps are in microseconds, thread 0 is the computation and
+            // thread 1 the asynchronous communication
+            auto span = [&] (const char* name, const SliceTrace& trace, int tid,
+                             double begin, double end) {
+                if (begin < 0. || end < begin) return;
+                ofs << ",\n" << R"({"name":")" << name << R"(","ph":"X","pid":)" << r
+                    << R"(,"tid":)" << tid << R"(,"ts":)" << 1.e6 * begin
+                    << R"(,"dur":)" << 1.e6 * (end - begin)
+                    << R"(,"args":{"step":)" << trace.m_step << R"(,"slice":)" << trace.m_slice
+                    << "}}";
+            };
+            double span_start = 0.;
+            for (const auto& trace : m_trace_data) {
+                if (trace.m_slice == m_nslices - 1) {
+                    span_start = trace.m_get_end;
+                }
+                span("compute", trace, 0, span_start, trace.m_put_begin);
+                span("get_data", trace, 0, trace.m_get_begin, trace.m_get_end);
+                span("put_data", trace, 0, trace.m_put_begin, trace.m_put_end);
+                span("send", trace, 1, trace.m_put_begin, trace.m_send_complete);
+                span("receive_ready", trace, 1, trace.m_recv_ready, trace.m_recv_ready);
+                if (trace.m_put_end >= 0.) {
+                    span_start = trace.m_put_end;
+                }
+            }
+            if (r == n_ranks - 1) {
+                ofs << "\n]\n";
+            }
+            ofs.close();
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ofs, "Error while writing the pipeline trace");
+        }
+        amrex::ParallelDescriptor::Barrier();
+    }
 }
 
 amrex::Real MultiBuffer::get_time () {
@@ -658,6 +1023,17 @@ void MultiBuffer::write_metadata (int slice, MultiBeam& beams, MultiLaser& laser
         // write number of beam particles (per beam)
         get_metadata_location(slice)[b + 1] = beams.getBeam(b).getNumParticles(beam_slice);
     }
+    // write which components are stored in single precision, so that the receiving rank
+    // can unpack the buffer independently of its own settings
+    get_metadata_location(slice)[1 + m_nbeams] = m_fp32_mask;
+    // write the scale of the laser in half precision, it has to be known before
+    // the metadata is sent
+    double laser_scale = 1.;
+    if (laser.UseLaser(slice) && ((m_fp32_mask >> laser_fp16_bit) & 1)) {
+        laser_scale = get_laser_max_abs(laser, beam_slice);
+        if (!(laser_scale > 0.)) laser_scale = 1.;
+    }
+    std::memcpy(get_metadata_location(slice) + 2 + m_nbeams, &laser_scale, sizeof(double));
     std::size_t offset = get_buffer_offset(slice, offset_type::total, beams, laser, 0, 0);
     // write total buffer size
     get_metadata_location(slice)[0] = (offset+sizeof(storage_type)-1) / sizeof(storage_type);
@@ -667,6 +1043,28 @@ void MultiBuffer::write_metadata (int slice, MultiBeam& beams, MultiLaser& laser
     AMREX_ALWAYS_ASSERT(get_metadata_location(slice)[0] < std::numeric_limits<int>::max());
 }
 
+double MultiBuffer::get_laser_max_abs (MultiLaser& laser, int beam_slice) {
+    using namespace WhichLaserSlice;
+    // same components as in pack_data
+    const int laser_comp_0_1 = (beam_slice == WhichBeamSlice::Next) ? np1jp2_r : np1j00_r;
+    const int laser_comp_2_3 = (beam_slice == WhichBeamSlice::Next) ? n00jp2_r : n00j00_r;
+    const amrex::Array4<amrex::Real const> arr = laser.getSlices()[0].const_array();
+
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+    amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    reduce_op.eval(laser.getSlices()[0].box(), reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            return amrex::max(
+                amrex::max(amrex::Math::abs(arr(i, j, k, laser_comp_0_1)),
+                           amrex::Math::abs(arr(i, j, k, laser_comp_0_1 + 1))),
+                amrex::max(amrex::Math::abs(arr(i, j, k, laser_comp_2_3)),
+                           amrex::Math::abs(arr(i, j, k, laser_comp_2_3 + 1))));
+        });
+    return static_cast<double>(amrex::get<0>(reduce_data.value()));
+}
+
 std::size_t MultiBuffer::get_buffer_offset (int slice, offset_type type, MultiBeam& beams,
                                             MultiLaser& laser, int ibeam, int comp) {
     // calculate offset for each chunk of data in one place
@@ -693,7 +1091,7 @@ std::size_t MultiBuffer::get_buffer_offset (int slice, offset_type type, MultiBe
                 if (type == offset_type::beam_real && ibeam == b && rcomp == comp) {
                     return offset;
                 }
-                offset += num_particles_round_up * sizeof(amrex::Real);
+                offset += num_particles_round_up * get_real_size_in_buffer(slice, rcomp);
             }
         }
 
@@ -714,7 +1112,8 @@ std::size_t MultiBuffer::get_buffer_offset (int slice, offset_type type, MultiBe
             if (type == offset_type::laser && lcomp == comp) {
                 return offset;
             }
-            offset += laser.getSlices()[0].box().numPts() * sizeof(amrex::Real);
+            offset += laser.getSlices()[0].box().numPts()
+                * get_real_size_in_buffer(slice, laser_fp32_bit);
         }
     }
 
@@ -819,11 +1218,15 @@ void MultiBuffer::pack_data (int slice, MultiBeam& beams, MultiLaser& laser, int
 
         for (int rcomp = 0; rcomp < beam.numRealComponents(); ++rcomp) {
             // only pack real component if it should be communicated
-            if (beam.communicateRealComponent(rcomp)) {
+            if (beam.communicateRealComponent(rcomp) && is_fp32_in_buffer(slice, rcomp)) {
+                convert_to_buffer(slice, get_buffer_offset(slice, offset_type::beam_real,
+                                                           beams, laser, b, rcomp),
+                                  soa.GetRealData(rcomp).dataPtr(), num_particles);
+            } else if (beam.communicateRealComponent(rcomp)) {
                 memcpy_to_buffer(slice, get_buffer_offset(slice, offset_type::beam_real,
                                                           beams, laser, b, rcomp),
                                  soa.GetRealData(rcomp).dataPtr(),
-                                 num_particles * sizeof(amrex::Real));
+                                 num_particles * sizeof(amrex::ParticleReal));
             }
         }
 
@@ -842,12 +1245,29 @@ void MultiBuffer::pack_data (int slice, MultiBeam& beams, MultiLaser& laser, int
         const int laser_comp_0_1 = (beam_slice == WhichBeamSlice::Next) ? np1jp2_r : np1j00_r;
         const int laser_comp_2_3 = (beam_slice == WhichBeamSlice::Next) ? n00jp2_r : n00j00_r;
         // copy real and imag components in one operation
-        memcpy_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
-                         laser.getSlices()[0].dataPtr(laser_comp_0_1),
-                         2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
-        memcpy_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
-                         laser.getSlices()[0].dataPtr(laser_comp_2_3),
-                         2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+        if (is_fp16_laser_in_buffer(slice)) {
+            const double scale = get_laser_scale_in_buffer(slice);
+            convert_to_fp16_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                                   laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                                   2 * laser.getSlices()[0].box().numPts(), scale);
+            convert_to_fp16_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                                   laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                                   2 * laser.getSlices()[0].box().numPts(), scale);
+        } else if (is_fp32_in_buffer(slice, laser_fp32_bit)) {
+            convert_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                              laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                              2 * laser.getSlices()[0].box().numPts());
+            convert_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                              laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                              2 * laser.getSlices()[0].box().numPts());
+        } else {
+            memcpy_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                             laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                             2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+            memcpy_to_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                             laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                             2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+        }
     }
     amrex::Gpu::streamSynchronize();
     for (int b = 0; b < m_nbeams; ++b) {
@@ -879,17 +1299,22 @@ void MultiBuffer::unpack_data (int slice, MultiBeam& beams, MultiLaser& laser, i
         }
 
         for (int rcomp = 0; rcomp < beam.numRealComponents(); ++rcomp) {
-            if (beam.communicateRealComponent(rcomp)) {
+            if (beam.communicateRealComponent(rcomp) && is_fp32_in_buffer(slice, rcomp)) {
+                // unpack and convert single precision real component
+                convert_from_buffer(slice, get_buffer_offset(slice, offset_type::beam_real,
+                                                             beams, laser, b, rcomp),
+                                    soa.GetRealData(rcomp).dataPtr(), num_particles);
+            } else if (beam.communicateRealComponent(rcomp)) {
                 // only unpack real component if it should be communicated
                 memcpy_from_buffer(slice, get_buffer_offset(slice, offset_type::beam_real,
                                                             beams, laser, b, rcomp),
                                    soa.GetRealData(rcomp).dataPtr(),
-                                   num_particles * sizeof(amrex::Real));
+                                   num_particles * sizeof(amrex::ParticleReal));
             } else {
                 // initialize per-slice-only real components to zero
-                amrex::Real* data_ptr = soa.GetRealData(rcomp).dataPtr();
+                amrex::ParticleReal* data_ptr = soa.GetRealData(rcomp).dataPtr();
                 amrex::ParallelFor(num_particles, [=] AMREX_GPU_DEVICE (int i) {
-                    data_ptr[i] = amrex::Real(0.);
+                    data_ptr[i] = amrex::ParticleReal(0.);
                 });
             }
         }
@@ -915,12 +1340,79 @@ void MultiBuffer::unpack_data (int slice, MultiBeam& beams, MultiLaser& laser, i
         const int laser_comp_0_1 = (beam_slice == WhichBeamSlice::Next) ? n00jp2_r : n00j00_r;
         const int laser_comp_2_3 = (beam_slice == WhichBeamSlice::Next) ? nm1jp2_r : nm1j00_r;
         // copy real and imag components in one operation
-        memcpy_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
-                           laser.getSlices()[0].dataPtr(laser_comp_0_1),
-                           2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
-        memcpy_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
-                           laser.getSlices()[0].dataPtr(laser_comp_2_3),
-                           2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+        if (is_fp16_laser_in_buffer(slice)) {
+            const double scale = get_laser_scale_in_buffer(slice);
+            convert_from_fp16_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                                     laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                                     2 * laser.getSlices()[0].box().numPts(), scale);
+            convert_from_fp16_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                                     laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                                     2 * laser.getSlices()[0].box().numPts(), scale);
+        } else if (is_fp32_in_buffer(slice, laser_fp32_bit)) {
+            convert_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                                laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                                2 * laser.getSlices()[0].box().numPts());
+            convert_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                                laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                                2 * laser.getSlices()[0].box().numPts());
+        } else {
+            memcpy_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 0),
+                               laser.getSlices()[0].dataPtr(laser_comp_0_1),
+                               2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+            memcpy_from_buffer(slice, get_buffer_offset(slice, offset_type::laser, beams, laser, 0, 2),
+                               laser.getSlices()[0].dataPtr(laser_comp_2_3),
+                               2 * laser.getSlices()[0].box().numPts() * sizeof(amrex::Real));
+        }
     }
     amrex::Gpu::streamSynchronize();
 }
+
+template<class T>
+void MultiBuffer::convert_to_buffer (int slice, std::size_t buffer_offset,
+                                     const T* src_ptr, std::size_t num_elements) {
+    // with async_memcpy the data is packed into the gpu buffer first, otherwise the kernel
+    // writes directly into the pinned or device buffer
+    char* buffer = m_async_memcpy ? m_trailing_gpu_buffer.dataPtr() : m_datanodes[slice].m_buffer;
+    float* dst_ptr = reinterpret_cast<float*>(buffer + buffer_offset);
+    amrex::ParallelFor(static_cast<amrex::Long>(num_elements),
+        [=] AMREX_GPU_DEVICE (amrex::Long i) {
+            dst_ptr[i] = static_cast<float>(src_ptr[i]);
+        });
+}
+
+template<class T>
+void MultiBuffer::convert_from_buffer (int slice, std::size_t buffer_offset,
+                                       T* dst_ptr, std::size_t num_elements) {
+    const char* buffer = m_async_memcpy ? m_leading_gpu_buffer.dataPtr()
+                                        : m_datanodes[slice].m_buffer;
+    const float* src_ptr = reinterpret_cast<const float*>(buffer + buffer_offset);
+    amrex::ParallelFor(static_cast<amrex::Long>(num_elements),
+        [=] AMREX_GPU_DEVICE (amrex::Long i) {
+            dst_ptr[i] = static_cast<T>(src_ptr[i]);
+        });
+}
+
+void MultiBuffer::convert_to_fp16_buffer (int slice, std::size_t buffer_offset,
+                                          const amrex::Real* src_ptr, std::size_t num_elements,
+                                          double scale) {
+    char* buffer = m_async_memcpy ? m_trailing_gpu_buffer.dataPtr() : m_datanodes[slice].m_buffer;
+    std::uint16_t* dst_ptr = reinterpret_cast<std::uint16_t*>(buffer + buffer_offset);
+    const amrex::Real inv_scale = static_cast<amrex::Real>(1. / scale);
+    amrex::ParallelFor(static_cast<amrex::Long>(num_elements),
+        [=] AMREX_GPU_DEVICE (amrex::Long i) {
+            dst_ptr[i] = float_to_half(static_cast<float>(src_ptr[i] * inv_scale));
+        });
+}
+
+void MultiBuffer::convert_from_fp16_buffer (int slice, std::size_t buffer_offset,
+                                            amrex::Real* dst_ptr, std::size_t num_elements,
+                                            double scale) {
+    const char* buffer = m_async_memcpy ? m_leading_gpu_buffer.dataPtr()
+                                        : m_datanodes[slice].m_buffer;
+    const std::uint16_t* src_ptr = reinterpret_cast<const std::uint16_t*>(buffer + buffer_offset);
+    const amrex::Real real_scale = static_cast<amrex::Real>(scale);
+    amrex::ParallelFor(static_cast<amrex::Long>(num_elements),
+        [=] AMREX_GPU_DEVICE (amrex::Long i) {
+            dst_ptr[i] = static_cast<amrex::Real>(half_to_float(src_ptr[i])) * real_scale;
+        });
+}
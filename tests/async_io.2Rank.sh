@@ -0,0 +1,70 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with the output written by a background thread
+# and compares all output steps with the output written synchronously
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf $TEST_NAME
+
+# Run the simulation with the output written synchronously
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        amr.n_cell = 32 32 50 \
+        max_step = 3 \
+        diagnostic.output_period = 1 \
+        hipace.file_prefix=$TEST_NAME/sync
+
+# Run the simulation with the output written by the IO thread
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        amr.n_cell = 32 32 50 \
+        max_step = 3 \
+        diagnostic.output_period = 1 \
+        diagnostic.async_io = 1 \
+        diagnostic.async_io_max_in_flight = 2 \
+        hipace.file_prefix=$TEST_NAME/async
+
+# Compare the fields and the beam of all output steps
+python3 - $TEST_NAME <<'EOF_PY'
+import sys
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+ts_sync = OpenPMDTimeSeries(sys.argv[1] + "/sync")
+ts_async = OpenPMDTimeSeries(sys.argv[1] + "/async")
+assert list(ts_sync.iterations) == [0, 1, 2, 3]
+assert list(ts_async.iterations) == list(ts_sync.iterations)
+
+for iteration in ts_sync.iterations:
+    for field in ["Ez", "ExmBy", "EypBx", "Bx", "By"]:
+        F_sync, _ = ts_sync.get_field(field=field, iteration=iteration)
+        F_async, _ = ts_async.get_field(field=field, iteration=iteration)
+        assert np.array_equal(F_sync, F_async), (field, iteration)
+    beam_vars = ["x", "y", "z", "ux", "uy", "uz", "w"]
+    for var_sync, var_async in zip(
+            ts_sync.get_particle(beam_vars, species="beam", iteration=iteration),
+            ts_async.get_particle(beam_vars, species="beam", iteration=iteration)):
+        assert np.array_equal(np.sort(var_sync), np.sort(var_async)), iteration
+    print("iteration", iteration, "is identical")
+EOF_PY
+
+rm -rf $TEST_NAME
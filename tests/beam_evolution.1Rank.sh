@@ -52,3 +52,33 @@ $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --rtol $RTOL \
     --file_name $TEST_NAME \
     --test-name $TEST_NAME
+
+echo "Start testing adaptive sub-cycling"
+
+rm -rf ${TEST_NAME}_adaptive
+# The external field is linear, so the force along the trajectory is smooth
+# and the pusher merges sub-cycles
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.tile_size = 8 \
+        amr.n_cell = 32 32 10 \
+        max_step = 20 \
+        geometry.prob_lo = -2. -2. -2. \
+        geometry.prob_hi =  2.  2.  2. \
+        hipace.dt = 3. \
+        diagnostic.output_period = 20 \
+        beam.density = 1.e-8 \
+        beam.radius = 1. \
+        beam.ppc = 4 4 1 \
+        'beams.external_E(x,y,z,t) = .5*x .5*y 0.' \
+        beams.adaptive_subcycling = 1 \
+        hipace.file_prefix = ${TEST_NAME}_adaptive
+
+# The merged sub-cycles must still follow the theory
+$HIPACE_EXAMPLE_DIR/analysis_beam_push.py --output-dir=${TEST_NAME}_adaptive
+
+# and stay close to the fixed sub-cycling
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --rtol 1e-3 \
+    --file_name ${TEST_NAME}_adaptive \
+    --test-name $TEST_NAME
@@ -0,0 +1,92 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ performance benchmarks.
+# It runs one scaled-down, deterministic benchmark and compares the time per particle push,
+# per cell update and per phase of the slice loop with the stored baseline of the platform.
+# Usage: benchmark.sh <executable> <source dir> <benchmark name> <platform> [--update]
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+BENCHMARK=$3
+PLATFORM=$4
+UPDATE=${5:-}
+
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+TEST_NAME=benchmark.${BENCHMARK}
+
+rm -rf $TEST_NAME
+mkdir -p $TEST_NAME
+
+# common options: few time steps, no output, report the timings
+COMMON_ARGS="max_step = 2 \
+             diagnostic.output_period = 0 \
+             hipace.verbose = 1 \
+             hipace.phase_timers_period = 1 \
+             hipace.phase_timers_file_prefix = $TEST_NAME \
+             hipace.file_prefix = $TEST_NAME/diags"
+
+case $BENCHMARK in
+    pwfa)
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/get_started/inputs_pwfa
+        EXTRA_ARGS="amr.n_cell = 256 256 320"
+        ;;
+    lwfa)
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/get_started/inputs_lwfa
+        EXTRA_ARGS="amr.n_cell = 256 256 256"
+        ;;
+    ionization)
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/blowout_wake/inputs_ionization_SI
+        EXTRA_ARGS="hipace.dt = 1e-12"
+        ;;
+    collisions)
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/blowout_wake/inputs_SI
+        EXTRA_ARGS="amr.n_cell = 128 128 100 \
+                    hipace.collisions = collision1 \
+                    collision1.species = plasma plasma"
+        ;;
+    mr)
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/get_started/inputs_pwfa
+        EXTRA_ARGS="amr.n_cell = 256 256 320 \
+                    amr.max_level = 1 \
+                    mr_lev1.n_cell = 128 128 \
+                    mr_lev1.patch_lo = -25.e-6 -25.e-6 -250.e-6 \
+                    mr_lev1.patch_hi = 25.e-6 25.e-6 110.e-6"
+        ;;
+    salame)
+        # SALAME only runs in the first time step, which is therefore the only one of this
+        # benchmark. A tolerance of 0 makes every slice do all hipace.salame_n_iter iterations.
+        INPUTS=${HIPACE_SOURCE_DIR}/examples/get_started/inputs_pwfa
+        EXTRA_ARGS="amr.n_cell = 256 256 320 \
+                    max_step = 0 \
+                    witness.do_salame = 1 \
+                    hipace.salame_n_iter = 5 \
+                    hipace.salame_relative_tolerance = 0."
+        ;;
+    *)
+        echo "Unknown benchmark $BENCHMARK"
+        exit 1
+        ;;
+esac
+
+# Run the simulation, the later arguments take precedence
+mpiexec -n 1 $HIPACE_EXECUTABLE $INPUTS $COMMON_ARGS $EXTRA_ARGS | tee $TEST_NAME/output.txt
+
+# Compare the timings with the baseline of this platform,
+# the exit code is 77 (skipped) if there is no baseline for this benchmark
+$HIPACE_SOURCE_DIR/tools/compare_benchmarks.py \
+    --name $BENCHMARK \
+    --output $TEST_NAME/output.txt \
+    --phase-timers "$TEST_NAME/phase_timers.*.txt" \
+    --baseline $HIPACE_TEST_DIR/benchmarks/baselines/${PLATFORM}.json \
+    $UPDATE
@@ -30,6 +30,7 @@ RTOL=1e-12 && [[ "$HIPACE_EXECUTABLE" == *"hipace"*".CUDA."* ]] && RTOL=2e-5
 
 rm -rf si_data
 rm -rf si_data_fixed_weight
+rm -rf si_data_fixed_weight_lazy
 rm -rf normalized_data
 rm -rf normalized_data_cd2
 # Run the simulation
@@ -45,6 +46,14 @@ mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
         hipace.file_prefix=si_data_fixed_weight/ \
         max_step=1
 
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        hipace.tile_size = 8 \
+        beam.injection_type=fixed_weight \
+        beam.num_particles=1000000 \
+        beam.lazy_generation=1 \
+        hipace.file_prefix=si_data_fixed_weight_lazy/ \
+        max_step=1
+
 mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
         hipace.tile_size = 8 \
         hipace.file_prefix=normalized_data/ \
@@ -56,6 +65,12 @@ $HIPACE_EXAMPLE_DIR/analysis.py \
     --si-data si_data/ \
     --si-fixed-weight-data si_data_fixed_weight/
 
+# The beam generated slice by slice has different random numbers, but the same wake
+$HIPACE_EXAMPLE_DIR/analysis.py \
+    --normalized-data normalized_data/ \
+    --si-data si_data/ \
+    --si-fixed-weight-data si_data_fixed_weight_lazy/
+
 # Compare the results with checksum benchmark
 $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --evaluate \
@@ -28,6 +28,8 @@ TEST_NAME="${FILE_NAME%.*}"
 
 rm -rf $TEST_NAME
 rm -rf ${TEST_NAME}_cd2
+rm -rf ${TEST_NAME}_bicgstab
+rm -rf ${TEST_NAME}_simd
 # Run the simulation
 mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
         hipace.tile_size = 8 \
@@ -54,3 +56,37 @@ $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --file_name ${TEST_NAME}_cd2 \
     --test-name $TEST_NAME \
     --skip "{'lev=0' : ['Sy', 'Sx', 'chi']}"
+
+echo "Start testing the FFT-preconditioned BiCGStab solver"
+
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.tile_size = 8 \
+        hipace.file_prefix=${TEST_NAME}_bicgstab \
+        hipace.use_fft_bicgstab = 1 \
+        hipace.MG_tolerance_rel = 1e-6 \
+        max_step=1
+
+# Both solvers converge to the same tolerance, but not to the same bits
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --file_name ${TEST_NAME}_bicgstab \
+    --test-name $TEST_NAME \
+    --rtol 1e-3 \
+    --skip "{'lev=0' : ['Sy', 'Sx', 'chi']}"
+
+echo "Start testing the batched SIMD deposition"
+
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.tile_size = 8 \
+        hipace.file_prefix=${TEST_NAME}_simd \
+        hipace.do_tiling = 1 \
+        hipace.do_simd_depos = 1 \
+        max_step=1
+
+# The buffers of the particles are added in the same order, only the rounding can differ
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --file_name ${TEST_NAME}_simd \
+    --test-name $TEST_NAME \
+    --rtol 1e-8 \
+    --skip "{'lev=0' : ['Sy', 'Sx', 'chi']}"
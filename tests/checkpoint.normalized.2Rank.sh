@@ -0,0 +1,63 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+# This file runs a Hipace simulation in the blowout regime without interruption, and a second one
+# that stops with a checkpoint and is restarted from the beams of the checkpoint.
+# The beams at the end of both simulations are compared.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+rm -rf ${TEST_NAME}_full
+rm -rf ${TEST_NAME}_checkpoint
+rm -rf ${TEST_NAME}_restart
+
+COMMON_ARGS="hipace.tile_size = 8 \
+             amr.n_cell = 32 32 50 \
+             hipace.dt = 10."
+
+# Run the simulation without interruption
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        hipace.file_prefix=${TEST_NAME}_full \
+        max_step = 5
+
+# Run the same simulation, but stop it with a checkpoint at step 2
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        hipace.file_prefix=${TEST_NAME}_checkpoint \
+        hipace.checkpoint_step = 2 \
+        max_step = 5
+
+# Restart the remaining 3 time steps from the beams of the checkpoint
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        hipace.file_prefix=${TEST_NAME}_restart \
+        beam.injection_type = from_file \
+        beam.input_file = ${TEST_NAME}_checkpoint/openpmd_%T.h5 \
+        beam.iteration = 2 \
+        beam.openPMD_species_name = beam \
+        beam.plasma_density = 0 \
+        max_step = 3
+
+# Compare the beams at the end of both simulations. The beam particles are deposited in a
+# different order after the restart, so the results are not identical to the last bit.
+$HIPACE_SOURCE_DIR/examples/beam_in_vacuum/analysis_from_file.py \
+        --beam-out1 ${TEST_NAME}_full/openpmd_%T.h5 --iteration1 5 \
+        --beam-out2 ${TEST_NAME}_restart/openpmd_%T.h5 --iteration2 3 \
+        --rtol 1e-6
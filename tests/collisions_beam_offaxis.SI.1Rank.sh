@@ -0,0 +1,65 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs beam-plasma collisions on a grid with nx != ny, with a plasma only at x > 20 um.
+# A beam at x = -40 um must not collide with the plasma, a beam at x = 40 um must.
+# This checks that beam and plasma particles are only paired within the same cell.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf $TEST_NAME
+
+for x in -40.e-6 40.e-6; do
+    for collisions in 0 1; do
+        ARGS=""
+        if [ $collisions -eq 1 ]; then
+            ARGS="hipace.collisions = collision1 collision1.species = beam plasma"
+        fi
+        OMP_NUM_THREADS=1 mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+                amr.n_cell = 64 48 100 \
+                max_step = 1 \
+                hipace.do_tiling = 0 \
+                "plasma.density(x,y,z)" = "ne*(x>20.e-6)" \
+                beam.position_mean = $x 0. 0. \
+                $ARGS \
+                hipace.file_prefix=$TEST_NAME/x${x}_collisions${collisions}
+    done
+done
+
+python3 - $TEST_NAME <<'EOF_PY'
+import sys
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+def beam_momenta(path):
+    ts = OpenPMDTimeSeries(path)
+    return ts.get_particle(["ux", "uy", "uz"], species="beam", iteration=1)
+
+for x, should_collide in [("-40.e-6", False), ("40.e-6", True)]:
+    ref = beam_momenta(sys.argv[1] + "/x" + x + "_collisions0")
+    col = beam_momenta(sys.argv[1] + "/x" + x + "_collisions1")
+    unchanged = all(np.array_equal(r, c) for r, c in zip(ref, col))
+    print("beam at x = " + x + ": momenta " + ("unchanged" if unchanged else "changed"))
+    assert unchanged != should_collide
+EOF_PY
+
+rm -rf $TEST_NAME
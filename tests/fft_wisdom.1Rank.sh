@@ -0,0 +1,61 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation three times with the same FFTW wisdom file: the first run
+# creates it, the second run imports it, and the third run starts from a corrupt file.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/linear_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+WISDOM_FILE=$TEST_NAME/fftw_wisdom.txt
+
+rm -rf $TEST_NAME
+mkdir -p $TEST_NAME
+
+# The wisdom file does not exist yet and is written at the end of the run
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.fft_wisdom_file = $WISDOM_FILE \
+        hipace.file_prefix=$TEST_NAME/first | tee $TEST_NAME/first.txt
+[ -s $WISDOM_FILE ] || { echo "$WISDOM_FILE was not written"; exit 1; }
+head -c 5 $WISDOM_FILE | grep -q "(fftw" || { echo "$WISDOM_FILE is not FFTW wisdom"; exit 1; }
+
+# The wisdom is imported and written back, the result does not change
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.fft_wisdom_file = $WISDOM_FILE \
+        hipace.file_prefix=$TEST_NAME/second | tee $TEST_NAME/second.txt
+if grep -q "WARNING: could not" $TEST_NAME/first.txt $TEST_NAME/second.txt; then
+    echo "Reading or writing the FFTW wisdom failed"
+    exit 1
+fi
+[ -s $WISDOM_FILE ] || { echo "$WISDOM_FILE is empty after the second run"; exit 1; }
+ls $TEST_NAME | grep -q "tmp" && { echo "temporary wisdom file left behind"; exit 1; }
+
+${HIPACE_SOURCE_DIR}/examples/linear_wake/analysis_equal.py \
+    --first=$TEST_NAME/first --second=$TEST_NAME/second
+
+# A corrupt wisdom file gives a warning and is replaced with valid wisdom
+echo "not fftw wisdom" > $WISDOM_FILE
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.fft_wisdom_file = $WISDOM_FILE \
+        hipace.file_prefix=$TEST_NAME/corrupt | tee $TEST_NAME/corrupt.txt
+grep -q "WARNING: could not import the FFTW wisdom" $TEST_NAME/corrupt.txt
+head -c 5 $WISDOM_FILE | grep -q "(fftw" || { echo "$WISDOM_FILE was not replaced"; exit 1; }
+
+rm -rf $TEST_NAME
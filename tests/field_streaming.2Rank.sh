@@ -0,0 +1,68 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with regular and streamed field IO and compares them
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+# Run the simulation with the full diagnostic box in memory
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        amr.n_cell = 60 60 100 \
+        max_step = 1 \
+        diagnostic.field_data = Ez ExmBy EypBx Bx By \
+        diagnostic.coarsening = 1 1 3 \
+        hipace.file_prefix=$TEST_NAME/full
+
+# Run the simulation with the field diagnostic streamed in z chunks
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        amr.n_cell = 60 60 100 \
+        max_step = 1 \
+        diagnostic.field_data = Ez ExmBy EypBx Bx By \
+        diagnostic.coarsening = 1 1 3 \
+        diagnostic.streaming_chunk_size = 4 \
+        diagnostic.streaming_host_buffers = 2 \
+        hipace.file_prefix=$TEST_NAME/streamed
+
+# Compare the results
+${HIPACE_SOURCE_DIR}/examples/linear_wake/analysis_equal.py \
+    --first=$TEST_NAME/full --second=$TEST_NAME/streamed
+
+# With ADIOS2, the chunks are written into spans of the engine buffer,
+# which is flushed to disk after every streaming_host_buffers chunks
+if python3 -c "import openpmd_api as io, sys; sys.exit(0 if io.variants['adios2'] else 1)"
+then
+    mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+            amr.n_cell = 60 60 100 \
+            max_step = 1 \
+            diagnostic.field_data = Ez ExmBy EypBx Bx By \
+            diagnostic.coarsening = 1 1 3 \
+            diagnostic.streaming_chunk_size = 4 \
+            diagnostic.streaming_host_buffers = 2 \
+            hipace.openpmd_backend = bp \
+            hipace.file_prefix=$TEST_NAME/streamed_bp
+
+    ${HIPACE_SOURCE_DIR}/examples/linear_wake/analysis_equal.py \
+        --first=$TEST_NAME/full --second=$TEST_NAME/streamed_bp
+else
+    echo "openPMD-api was built without ADIOS2, not testing the streamed bp output"
+fi
+
+rm -rf $TEST_NAME
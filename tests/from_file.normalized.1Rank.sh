@@ -39,6 +39,7 @@ $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
         beam.input_file = beam_%T.h5 \
         beam.iteration = 0 \
         beam.openPMD_species_name = Electrons \
+        beam.file_chunk_size = 300000 \
         beam.plasma_density = 2.8239587008591567e23 # to convert beam to normalized units
 
 # Compare the beams
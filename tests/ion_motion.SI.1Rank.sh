@@ -37,9 +37,20 @@ mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_ion_motion_SI \
         hipace.bxby_solver = explicit \
         hipace.file_prefix=$TEST_NAME/e
 
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_ion_motion_SI \
+        hipace.bxby_solver = predictor-corrector \
+        hipace.predcorr_anderson_depth = 3 \
+        hipace.predcorr_B_mixing_factor = 0.0635 \
+        hipace.predcorr_max_iterations = 30 \
+        hipace.predcorr_B_error_tolerance = 0.0001 \
+        hipace.file_prefix=$TEST_NAME/pc_anderson
+
 # Compare the result with theory
 $HIPACE_EXAMPLE_DIR/analysis_equal.py --first=$TEST_NAME/pc  --second=$TEST_NAME/e
 
+# The predictor-corrector loop with Anderson acceleration converges to the same fields
+$HIPACE_EXAMPLE_DIR/analysis_equal.py --first=$TEST_NAME/pc_anderson  --second=$TEST_NAME/e
+
 # Compare the results with checksum benchmark
 $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --evaluate \
@@ -26,6 +26,7 @@ FILE_NAME=`basename "$0"`
 TEST_NAME="${FILE_NAME%.*}"
 
 rm -rf $TEST_NAME
+rm -rf ${TEST_NAME}_table
 
 # Run the simulation
 mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_ionization_SI \
@@ -41,3 +42,22 @@ $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --file_name $TEST_NAME \
     --test-name $TEST_NAME \
     --skip "{'beam': 'id'}"
+
+echo "Start testing the tabulated ADK rate"
+
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_ionization_SI \
+        hipace.tile_size = 8 \
+        hipace.dt = 1e-12 \
+        diagnostic.output_period = 2 \
+        plasmas.ionization_table_size = 1024 \
+        hipace.file_prefix=${TEST_NAME}_table \
+        max_step=2
+
+# The interpolated rate differs slightly, so a few particles close to the
+# ionization threshold can make a different random decision
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --file_name ${TEST_NAME}_table \
+    --test-name $TEST_NAME \
+    --rtol 1e-2 \
+    --skip "{'beam': 'id'}"
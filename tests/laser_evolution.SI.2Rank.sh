@@ -37,6 +37,16 @@ $HIPACE_EXAMPLE_DIR/analysis_laser_vacuum.py --output-dir=$TEST_NAME
 
 rm -rf $TEST_NAME
 
+# Run the simulation with multigrid Poisson solver restricted to the active window
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        lasers.solver_type = multigrid \
+        lasers.active_window_threshold = 1.e-4 \
+        hipace.file_prefix = $TEST_NAME
+# Compare the result with theory
+$HIPACE_EXAMPLE_DIR/analysis_laser_vacuum.py --output-dir=$TEST_NAME
+
+rm -rf $TEST_NAME
+
 # Run the simulation with FFT Poisson solver
 mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
         lasers.solver_type = fft \
@@ -50,3 +60,21 @@ $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --rtol $RTOL \
     --file_name $TEST_NAME \
     --test-name $TEST_NAME
+
+rm -rf $TEST_NAME
+
+# Run the simulation with the laser communicated in half precision
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        lasers.solver_type = fft \
+        comms_buffer.fp16_laser = 1 \
+        hipace.file_prefix = $TEST_NAME
+# Compare the result with theory
+$HIPACE_EXAMPLE_DIR/analysis_laser_vacuum.py --output-dir=$TEST_NAME
+# Compare the results with checksum benchmark, the envelope is rounded to half precision
+# once per time step
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --skip-particles \
+    --evaluate \
+    --rtol 1e-2 \
+    --file_name $TEST_NAME \
+    --test-name $TEST_NAME
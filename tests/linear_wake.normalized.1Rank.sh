@@ -43,3 +43,47 @@ $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --rtol $RTOL \
     --file_name $TEST_NAME \
     --test-name $TEST_NAME
+
+# Run the simulation with the density tabulated per particle, this gives the same result
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.tile_size = 8 \
+        diagnostic.field_data = all rho \
+        plasma.density_tabulation = exact \
+        hipace.file_prefix=${TEST_NAME}_exact
+
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --rtol $RTOL \
+    --file_name ${TEST_NAME}_exact \
+    --test-name $TEST_NAME
+
+# Run the simulation with the density interpolated from the grid nodes,
+# which is exact for a uniform density
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.tile_size = 8 \
+        diagnostic.field_data = all rho \
+        plasma.density_tabulation = interpolate \
+        hipace.file_prefix=${TEST_NAME}_interpolate
+
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --rtol 1e-10 \
+    --file_name ${TEST_NAME}_interpolate \
+    --test-name $TEST_NAME
+
+rm -rf ${TEST_NAME}_exact ${TEST_NAME}_interpolate
+
+# In a parabolic channel, the interpolated density is close to the density function
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        "plasma.density(x,y,z)" = "1.+0.01*(x^2+y^2)" \
+        hipace.file_prefix=${TEST_NAME}_channel/none
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        "plasma.density(x,y,z)" = "1.+0.01*(x^2+y^2)" \
+        plasma.density_tabulation = interpolate \
+        hipace.file_prefix=${TEST_NAME}_channel/interpolate
+
+$HIPACE_EXAMPLE_DIR/analysis_equal.py \
+    --first=${TEST_NAME}_channel/none --second=${TEST_NAME}_channel/interpolate
+
+rm -rf ${TEST_NAME}_channel
@@ -0,0 +1,102 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with a refined patch that tracks an off-axis beam.
+# It checks that the patch has moved by the expected number of coarse cells after the
+# first time step, that the fields match a run with a fixed patch at that position,
+# and that a patch that would leave the coarse level is moved back until it is nested.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+# GPU graphs captured in the first time step must not be reused once the patch moved
+GRAPH_ARGS="" && [[ "$HIPACE_EXECUTABLE" == *"hipace"*".CUDA."* ]] && GRAPH_ARGS="hipace.use_gpu_graphs = 1"
+
+rm -rf $TEST_NAME
+
+# coarse cells of 0.25, fine cells of 0.125. The beam is centered on a coarse cell edge,
+# so its centroid is exactly at position_mean. A small time step keeps the beam in place
+COMMON_ARGS="amr.n_cell = 64 64 50 \
+             amr.max_level = 1 \
+             mr_lev1.n_cell = 32 32 \
+             max_step = 1 \
+             hipace.dt = 1.e-3 \
+             $GRAPH_ARGS"
+
+# Patch tracking a beam at x = 1.5, y = -1, it moves by 6 and -4 coarse cells
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        beam.position_mean = 1.5 -1. 0. \
+        mr_lev1.patch_lo = -2. -2. -6. \
+        mr_lev1.patch_hi = 2. 2. 6. \
+        mr_lev1.track_beam = beam \
+        hipace.file_prefix=$TEST_NAME/tracked
+
+# Fixed patch at the position of the tracked patch in the second time step
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        beam.position_mean = 1.5 -1. 0. \
+        mr_lev1.patch_lo = -0.5 -3. -6. \
+        mr_lev1.patch_hi = 3.5 1. 6. \
+        hipace.file_prefix=$TEST_NAME/fixed
+
+# Patch tracking a beam at x = 6.5, which would leave the coarse level after 26 coarse cells.
+# With a margin of 2 fine and 2 coarse cells, it can only move by 20 coarse cells
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        $COMMON_ARGS \
+        beam.position_mean = 6.5 0. 0. \
+        mr_lev1.patch_lo = -2. -2. -6. \
+        mr_lev1.patch_hi = 2. 2. 6. \
+        mr_lev1.track_beam = beam \
+        hipace.file_prefix=$TEST_NAME/nested
+
+python3 - $TEST_NAME <<'EOF_PY'
+import sys
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+dx_coarse = 0.25
+ts_tracked = OpenPMDTimeSeries(sys.argv[1] + "/tracked")
+ts_fixed = OpenPMDTimeSeries(sys.argv[1] + "/fixed")
+ts_nested = OpenPMDTimeSeries(sys.argv[1] + "/nested")
+
+def patch_lo(ts, iteration):
+    _, info = ts.get_field(field="Ez_lev1", iteration=iteration)
+    return np.array([info.xmin, info.ymin])
+
+# number of coarse cells the patch moved between the first and the second time step
+for ts, expected in [(ts_tracked, [6, -4]), (ts_nested, [20, 0])]:
+    shift = (patch_lo(ts, 1) - patch_lo(ts, 0)) / dx_coarse
+    print("patch moved by", shift, "coarse cells, expected", expected)
+    assert np.allclose(shift, expected, rtol=0., atol=1e-6)
+
+# the moved patch gives the same fields as a patch that was placed there from the start
+assert np.allclose(patch_lo(ts_tracked, 1), patch_lo(ts_fixed, 1), rtol=0., atol=1e-12)
+for field in ["Ez", "ExmBy", "EypBx", "Bx", "By"]:
+    for lev in ["lev0", "lev1"]:
+        F_tracked, _ = ts_tracked.get_field(field=field + "_" + lev, iteration=1)
+        F_fixed, _ = ts_fixed.get_field(field=field + "_" + lev, iteration=1)
+        error = np.max(np.abs(F_tracked - F_fixed)) / np.max(np.abs(F_fixed))
+        print(field + "_" + lev, "relative error", error)
+        assert error < 1e-6
+EOF_PY
+
+rm -rf $TEST_NAME
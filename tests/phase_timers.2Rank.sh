@@ -0,0 +1,73 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with the per-phase timers and checks the files they write
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf $TEST_NAME
+
+# Run the simulation with the explicit solver, 4 time steps are distributed over 2 ranks
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        amr.n_cell = 32 32 50 \
+        max_step = 3 \
+        hipace.phase_timers_period = 1 \
+        hipace.phase_timers_file_prefix = $TEST_NAME/phase_timers \
+        hipace.file_prefix = $TEST_NAME/diags
+
+# Read the files of both ranks and check the number of calls and the timings
+python3 - $TEST_NAME/phase_timers <<'EOF_PY'
+import glob
+import json
+import sys
+
+import numpy as np
+
+n_slices = 50
+steps = []
+for rank, filename in enumerate(sorted(glob.glob(sys.argv[1] + "/phase_timers.*.txt"))):
+    with open(filename, "rb") as f:
+        data = f.read()
+    dtype, offset = json.JSONDecoder().raw_decode(data.decode(errors="replace"))
+    records = np.frombuffer(data, dtype=np.dtype(dtype), offset=offset)
+    # every rank computes every second time step
+    assert list(records["step"]) == list(range(rank, 4, 2)), filename
+    steps += list(records["step"])
+    for name in records["seconds"].dtype.names:
+        seconds = records["seconds"][name]
+        calls = records["calls"][name]
+        print(filename, name, seconds, calls)
+        assert np.all(np.isfinite(seconds)) and np.all(seconds >= 0.), name
+        assert np.all(calls >= 0), name
+        assert np.all((calls > 0) | (seconds == 0.)), name
+    # phases that run once per slice
+    for name in ["plasma_deposition", "beam_deposition", "explicit_deposition", "poisson_solve",
+                 "explicit_solve", "plasma_push", "beam_push", "multibuffer_send"]:
+        assert np.all(records["calls"][name] >= n_slices), name
+    # phases that are not used in this simulation
+    for name in ["predictor_corrector", "salame"]:
+        assert np.all(records["calls"][name] == 0), name
+    # the ranks wait for the beam of the previous time step
+    assert np.all(records["calls"]["multibuffer_receive"] == n_slices), filename
+assert sorted(steps) == [0, 1, 2, 3]
+EOF_PY
+
+rm -rf $TEST_NAME
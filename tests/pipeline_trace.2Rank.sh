@@ -0,0 +1,85 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with the trace of the time-step pipeline
+# and checks the printed summary and the Chrome trace file written by all ranks
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf $TEST_NAME
+mkdir -p $TEST_NAME
+
+# Run the simulation, 4 time steps of 50 slices are distributed over 2 ranks
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        amr.n_cell = 32 32 50 \
+        max_step = 3 \
+        diagnostic.output_period = 0 \
+        comms_buffer.trace = 1 \
+        comms_buffer.trace_file = $TEST_NAME/trace.json \
+        hipace.file_prefix=$TEST_NAME/diags | tee $TEST_NAME/output.txt
+
+python3 - $TEST_NAME <<'EOF_PY'
+import json
+import re
+import sys
+
+n_ranks = 2
+n_slices = 50
+n_steps_per_rank = 2
+
+with open(sys.argv[1] + "/output.txt") as f:
+    output = f.read()
+match = re.search(r"Pipeline trace over (\d+) ranks and ([0-9.eE+-]+) seconds:\n"
+                  r"  pipeline efficiency: ([0-9.eE+-]+) %\n"
+                  r"  critical rank: (\d+) with", output)
+assert match, "summary of the pipeline trace not found"
+assert int(match.group(1)) == n_ranks
+assert float(match.group(2)) > 0.
+assert 0. < float(match.group(3)) <= 100.
+assert 0 <= int(match.group(4)) < n_ranks
+
+# the file is only valid JSON if the ranks appended their events one after another
+with open(sys.argv[1] + "/trace.json") as f:
+    events = json.load(f)
+
+names = [e for e in events if e["ph"] == "M"]
+assert sorted(e["pid"] for e in names) == list(range(n_ranks))
+
+for rank in range(n_ranks):
+    spans = {}
+    for e in events:
+        if e["ph"] == "X" and e["pid"] == rank:
+            assert e["dur"] >= 0.
+            key = (e["args"]["step"], e["args"]["slice"])
+            spans.setdefault(e["name"], {})[key] = (e["ts"], e["ts"] + e["dur"])
+    # every slice of every time step of this rank is received, computed and sent once
+    for name in ["compute", "get_data", "put_data"]:
+        assert len(spans[name]) == n_steps_per_rank * n_slices, (rank, name, len(spans[name]))
+    # the next slice is received during the computation of the current slice
+    for (step, islice), (begin, end) in spans["get_data"].items():
+        if islice == n_slices - 1:
+            continue
+        compute_begin, compute_end = spans["compute"][(step, islice + 1)]
+        assert compute_begin <= begin and end <= compute_end, (rank, step, islice)
+    print("rank", rank, ":", {name: len(s) for name, s in spans.items()})
+EOF_PY
+
+rm -rf $TEST_NAME
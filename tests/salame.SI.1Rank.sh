@@ -0,0 +1,49 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with a SALAME witness beam, once with the SALAME Ez solves on the
+# full slice and once cropped to a sub-box around the witness, and compares the fields.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/get_started
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf $TEST_NAME
+
+COMMON_ARGS="hipace.tile_size = 8 \
+             amr.n_cell = 128 128 100 \
+             max_step = 0 \
+             hipace.verbose = 0 \
+             driver.num_particles = 100000 \
+             witness.num_particles = 100000 \
+             witness.do_salame = 1"
+
+# Run the simulation with the SALAME Ez solves on the full slice
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_pwfa \
+        $COMMON_ARGS \
+        hipace.file_prefix=$TEST_NAME/full
+
+# Run the simulation with the SALAME Ez solves cropped to the witness beam
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_pwfa \
+        $COMMON_ARGS \
+        hipace.salame_sub_box_guard_cells = 16 \
+        hipace.file_prefix=$TEST_NAME/sub_box
+
+# Compare the fields of both simulations
+$HIPACE_SOURCE_DIR/examples/linear_wake/analysis_equal.py \
+        --first=$TEST_NAME/full --second=$TEST_NAME/sub_box
@@ -0,0 +1,54 @@
+#! /usr/bin/env bash
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with the output streamed with the ADIOS2 SST engine
+# and checks that it finishes without a reader connected
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+# SST needs openPMD-api with ADIOS2, skip the test otherwise
+if ! python3 -c "import openpmd_api as io, sys; sys.exit(0 if io.variants['adios2'] else 1)"
+then
+    echo "openPMD-api was built without ADIOS2, skipping $TEST_NAME"
+    exit 77
+fi
+
+rm -rf $TEST_NAME
+
+# Run the simulation with every step streamed and nobody reading the streams,
+# the simulation must neither wait for a reader nor block on the full queue
+timeout 600 mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_SI \
+        amr.n_cell = 32 32 50 \
+        max_step = 4 \
+        diagnostic.output_period = 1 \
+        hipace.openpmd_backend = sst \
+        hipace.openpmd_sst_queue_limit = 1 \
+        hipace.file_prefix=$TEST_NAME
+
+# Nothing is written to file, and the contact files of the streams are removed
+# when the streams are closed at the end of the simulation
+if [ -n "$(find $TEST_NAME -type f 2>/dev/null)" ]; then
+    echo "Files left in the output directory of the SST stream:"
+    find $TEST_NAME -type f
+    exit 1
+fi
+
+rm -rf $TEST_NAME
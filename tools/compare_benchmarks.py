@@ -0,0 +1,119 @@
+#! /usr/bin/env python3
+
+# Copyright 2024
+#
+# This file is part of HiPACE++.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+Extract the timings of a HiPACE++ benchmark run and compare them with a stored baseline.
+
+The time per particle push and per cell update is read from the output of hipace.verbose = 1,
+the time per phase of the slice loop from the files written with hipace.phase_timers_period.
+The result is printed as JSON. The benchmark fails if a timing is slower than the baseline
+by more than the relative tolerance. If there is no baseline for the benchmark yet,
+the comparison is skipped and the exit code is SKIP_RETURN_CODE, so that CTest reports the
+benchmark as skipped instead of passed. Use --update to store the current timings as baseline.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import sys
+
+import numpy as np
+
+# exit code for a benchmark without baseline, SKIP_RETURN_CODE of the CTest benchmarks
+SKIP_RETURN_CODE = 77
+
+
+def read_output(filename):
+    """ns per particle push and per cell update from the output of Hipace::Evolve"""
+    timings = {}
+    patterns = {
+        "ns_per_particle_push": r"Total time per particle push: ([0-9.eE+-]+) nanoseconds",
+        "ns_per_cell_update": r"Total time per cell update: ([0-9.eE+-]+) nanoseconds",
+    }
+    with open(filename) as f:
+        text = f.read()
+    for key, pattern in patterns.items():
+        match = re.search(pattern, text)
+        if match:
+            timings[key] = float(match.group(1))
+    return timings
+
+
+def read_phase_timers(filenames):
+    """Seconds per phase, summed over all ranks and all time steps except the first one"""
+    timings = {}
+    for filename in sorted(glob.glob(filenames)):
+        with open(filename, "rb") as f:
+            data = f.read()
+        dtype, offset = json.JSONDecoder().raw_decode(data.decode(errors="replace"))
+        records = np.frombuffer(data, dtype=np.dtype(dtype), offset=offset)
+        # the first time step contains the initialization of the beams and FFT plans
+        records = records[records["step"] > 0] if np.any(records["step"] > 0) else records
+        for name in records["seconds"].dtype.names:
+            timings["phase_" + name + "_s"] = timings.get("phase_" + name + "_s", 0.) \
+                + float(np.sum(records["seconds"][name]))
+    return timings
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--name", required=True, help="name of the benchmark")
+    parser.add_argument("--output", required=True, help="file with the output of HiPACE++")
+    parser.add_argument("--phase-timers", default="",
+                        help="files written by the phase timers, '*' is a wildcard")
+    parser.add_argument("--baseline", required=True, help="JSON file with the baselines")
+    parser.add_argument("--rtol", type=float, default=0.1,
+                        help="relative slowdown compared to the baseline that is accepted")
+    parser.add_argument("--update", action="store_true",
+                        help="store the current timings as baseline instead of comparing")
+    args = parser.parse_args()
+
+    timings = read_output(args.output)
+    if args.phase_timers:
+        timings.update(read_phase_timers(args.phase_timers))
+    print(json.dumps({args.name: timings}, indent=4, sort_keys=True))
+
+    baselines = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baselines = json.load(f)
+
+    if args.update:
+        baselines[args.name] = timings
+        with open(args.baseline, "w") as f:
+            json.dump(baselines, f, indent=4, sort_keys=True)
+            f.write("\n")
+        print("Stored baseline of " + args.name + " in " + args.baseline)
+        return 0
+
+    if args.name not in baselines:
+        print("No baseline for " + args.name + " in " + args.baseline + ", skipping comparison")
+        return SKIP_RETURN_CODE
+
+    failed = False
+    for key, reference in sorted(baselines[args.name].items()):
+        if key not in timings:
+            print("missing  " + key)
+            failed = True
+            continue
+        # very short phases are dominated by noise
+        if reference <= 0. or (key.startswith("phase_") and reference < 1e-3):
+            continue
+        ratio = timings[key] / reference
+        status = "SLOWER  " if ratio > 1. + args.rtol else "ok      "
+        failed |= ratio > 1. + args.rtol
+        print(status + key + ": " + str(timings[key]) + " (baseline " + str(reference)
+              + ", ratio " + "{:.3f}".format(ratio) + ")")
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())